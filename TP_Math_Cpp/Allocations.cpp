@@ -0,0 +1,76 @@
+#include "Allocations.h"
+
+#ifdef MATHLIB_COMPTER_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::size_t> compteur{ 0 };
+
+	void* allouer(std::size_t size)
+	{
+		++compteur;
+		// malloc(0) may return nullptr, new must not
+		if (void* p = std::malloc(size ? size : 1))
+			return p;
+		throw std::bad_alloc();
+	}
+}
+
+// Every replaced new is released by one of the replaced delete below, all through malloc and free
+void* operator new(std::size_t size)
+{
+	return allouer(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return allouer(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+bool MathLib::allocationsComptees()
+{
+	return true;
+}
+
+std::size_t MathLib::allocations()
+{
+	return compteur;
+}
+
+#else
+
+bool MathLib::allocationsComptees()
+{
+	return false;
+}
+
+std::size_t MathLib::allocations()
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Count of the heap allocations of the program, used by the benchmarks
+ * The global operator new and delete are only replaced when the project defines MATHLIB_COMPTER_ALLOCATIONS,
+ * as the Debug configurations do, otherwise nothing is counted and the allocator of the program is left alone
+ */
+namespace MathLib
+{
+	// Whether the allocations are counted in this build
+	bool allocationsComptees();
+	// Number of calls to operator new since the start of the program, 0 when they are not counted
+	std::size_t allocations();
+}
@@ -0,0 +1,314 @@
+#include "BarnesHut.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	// Bits of a coordinate in a Morton code, 3 * 21 = 63 bits
+	constexpr int BITS = 21;
+	// Level whose cells are built in parallel, 8^2 = 64 subtrees
+	constexpr int NIVEAU_PARALLELE = 2;
+
+	// Spread the 21 low bits of v so that two of them are 3 bits apart
+	std::uint64_t etaler(std::uint64_t v)
+	{
+		v &= 0x1fffff;
+		v = (v | v << 32) & 0x1f00000000ffffULL;
+		v = (v | v << 16) & 0x1f0000ff0000ffULL;
+		v = (v | v << 8) & 0x100f00f00f00f00fULL;
+		v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+		v = (v | v << 2) & 0x1249249249249249ULL;
+		return v;
+	}
+
+	// Bounding box of the bodies
+	struct Boite
+	{
+		float min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		float max[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+	};
+
+	/**
+	 * Sort the (code, index) pairs: slices sorted in parallel, then merged pairwise
+	 * Ties are broken by the index, so the order does not depend on the number of slices
+	 */
+	void trier(std::vector<std::pair<std::uint64_t, std::uint32_t>>& cles)
+	{
+		const std::size_t n = cles.size();
+		const std::size_t tranches = std::min<std::size_t>(MathLib::nombreThreads(), n / 4096 + 1);
+		if (tranches <= 1)
+		{
+			std::sort(cles.begin(), cles.end());
+			return;
+		}
+		const auto borne = [&](std::size_t t) { return cles.begin() + static_cast<std::ptrdiff_t>(std::min(n, n * t / tranches)); };
+		MathLib::parallel_for(0, tranches, 1, [&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t t = first; t < last; t++)
+				std::sort(borne(t), borne(t + 1));
+		});
+		for (std::size_t largeur = 1; largeur < tranches; largeur *= 2)
+		{
+			const std::size_t paires = (tranches + 2 * largeur - 1) / (2 * largeur);
+			MathLib::parallel_for(0, paires, 1, [&](std::size_t first, std::size_t last)
+			{
+				for (std::size_t p = first; p < last; p++)
+				{
+					const std::size_t debut = 2 * largeur * p;
+					if (debut + largeur < tranches)
+						std::inplace_merge(borne(debut), borne(debut + largeur), borne(std::min(tranches, debut + 2 * largeur)));
+				}
+			});
+		}
+	}
+}
+
+BarnesHut::BarnesHut(float theta, float adoucissement)
+	: theta(theta), adoucissement(adoucissement)
+{
+	if (theta < 0 || adoucissement < 0)
+		throw std::invalid_argument("Opening angle and softening must be positive");
+}
+
+void BarnesHut::construire(const float* X, const float* Y, const float* Z, const float* masses, std::size_t n)
+{
+	if (n > std::numeric_limits<std::uint32_t>::max())
+		throw std::invalid_argument("Too many bodies for the tree");
+	noeuds.clear();
+	codes.resize(n);
+	px.resize(n);
+	py.resize(n);
+	pz.resize(n);
+	pm.resize(n);
+	ordre.resize(n);
+	if (n == 0)
+		return;
+
+	// Root cell: the cube holding every body
+	const Boite boite = MathLib::parallel_reduce(0, n, 1 << 14, Boite(), [&](std::size_t first, std::size_t last)
+	{
+		Boite b;
+		for (std::size_t i = first; i < last; i++)
+		{
+			const float p[3] = { X[i], Y[i], Z[i] };
+			for (int k = 0; k < 3; k++)
+			{
+				b.min[k] = std::min(b.min[k], p[k]);
+				b.max[k] = std::max(b.max[k], p[k]);
+			}
+		}
+		return b;
+	}, [](const Boite& a, const Boite& b)
+	{
+		Boite r;
+		for (int k = 0; k < 3; k++)
+		{
+			r.min[k] = std::min(a.min[k], b.min[k]);
+			r.max[k] = std::max(a.max[k], b.max[k]);
+		}
+		return r;
+	});
+	taille = std::max({ boite.max[0] - boite.min[0], boite.max[1] - boite.min[1], boite.max[2] - boite.min[2] });
+	if (!(taille > 0))
+		taille = 1;
+	// The bodies on the upper faces stay inside the last cell
+	const float echelle = static_cast<float>(1 << BITS) / (taille * 1.0001f);
+
+	std::vector<std::pair<std::uint64_t, std::uint32_t>> cles(n);
+	MathLib::parallel_for(0, n, 1 << 14, [&](std::size_t first, std::size_t last)
+	{
+		const auto quantifier = [echelle](float x, float min)
+		{
+			return static_cast<std::uint64_t>(std::min((x - min) * echelle, static_cast<float>((1 << BITS) - 1)));
+		};
+		for (std::size_t i = first; i < last; i++)
+		{
+			const std::uint64_t code = etaler(quantifier(X[i], boite.min[0])) << 2 | etaler(quantifier(Y[i], boite.min[1])) << 1
+				| etaler(quantifier(Z[i], boite.min[2]));
+			cles[i] = { code, static_cast<std::uint32_t>(i) };
+		}
+	});
+	trier(cles);
+	MathLib::parallel_for(0, n, 1 << 14, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t k = first; k < last; k++)
+		{
+			const std::uint32_t i = cles[k].second;
+			codes[k] = cles[k].first;
+			ordre[k] = i;
+			px[k] = X[i];
+			py[k] = Y[i];
+			pz[k] = Z[i];
+			pm[k] = masses[i];
+		}
+	});
+
+	// Subtrees of the cells of the second level, each one a contiguous range of bodies
+	constexpr std::size_t CELLULES = 1 << (3 * NIVEAU_PARALLELE);
+	constexpr int DECALAGE = 3 * (BITS - NIVEAU_PARALLELE);
+	std::vector<std::vector<Noeud>> sousArbres(CELLULES);
+	MathLib::parallel_for(0, CELLULES, 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t c = first; c < last; c++)
+		{
+			const auto debut = std::lower_bound(codes.begin(), codes.end(), static_cast<std::uint64_t>(c) << DECALAGE);
+			const auto fin = std::lower_bound(debut, codes.end(), static_cast<std::uint64_t>(c + 1) << DECALAGE);
+			if (debut != fin)
+				construireNoeud(sousArbres[c], debut - codes.begin(), fin - codes.begin(), NIVEAU_PARALLELE, nullptr);
+		}
+	});
+	construireNoeud(noeuds, 0, n, 0, &sousArbres);
+}
+
+void BarnesHut::construireNoeud(std::vector<Noeud>& sortie, std::size_t first, std::size_t last, int niveau,
+	const std::vector<std::vector<Noeud>>* sousArbres) const
+{
+	if (sousArbres && niveau == NIVEAU_PARALLELE)
+	{
+		// Already built, only the jumps move
+		const std::vector<Noeud>& sousArbre = (*sousArbres)[codes[first] >> (3 * (BITS - NIVEAU_PARALLELE))];
+		const auto decalage = static_cast<std::uint32_t>(sortie.size());
+		for (Noeud noeud : sousArbre)
+		{
+			noeud.saut += decalage;
+			sortie.push_back(noeud);
+		}
+		return;
+	}
+
+	const std::size_t index = sortie.size();
+	sortie.emplace_back();
+	Noeud noeud{};
+	noeud.taille = std::ldexp(taille, -niveau);
+	noeud.premier = static_cast<std::uint32_t>(first);
+	noeud.nombre = static_cast<std::uint32_t>(last - first);
+	noeud.feuille = last - first <= FEUILLE || niveau >= BITS;
+
+	// Center of mass of the bodies, or of the children
+	double m = 0, mx = 0, my = 0, mz = 0;
+	if (noeud.feuille)
+	{
+		for (std::size_t j = first; j < last; j++)
+		{
+			m += pm[j];
+			mx += static_cast<double>(pm[j]) * px[j];
+			my += static_cast<double>(pm[j]) * py[j];
+			mz += static_cast<double>(pm[j]) * pz[j];
+		}
+	}
+	else
+	{
+		// Children in Morton order: the bodies of a child share the code above its bits
+		const int decalage = 3 * (BITS - 1 - niveau);
+		const std::uint64_t masque = (std::uint64_t(1) << decalage) - 1;
+		std::size_t debut = first;
+		while (debut < last)
+		{
+			const std::size_t fin = std::upper_bound(codes.begin() + debut, codes.begin() + last, codes[debut] | masque) - codes.begin();
+			const std::size_t enfant = sortie.size();
+			construireNoeud(sortie, debut, fin, niveau + 1, sousArbres);
+			const Noeud& e = sortie[enfant];
+			m += e.masse;
+			mx += static_cast<double>(e.masse) * e.x;
+			my += static_cast<double>(e.masse) * e.y;
+			mz += static_cast<double>(e.masse) * e.z;
+			debut = fin;
+		}
+	}
+	noeud.masse = static_cast<float>(m);
+	noeud.x = m > 0 ? static_cast<float>(mx / m) : px[first];
+	noeud.y = m > 0 ? static_cast<float>(my / m) : py[first];
+	noeud.z = m > 0 ? static_cast<float>(mz / m) : pz[first];
+	noeud.saut = static_cast<std::uint32_t>(sortie.size());
+	sortie[index] = noeud;
+}
+
+FVector3 BarnesHut::acceleration(const FVector3& p, float constante) const
+{
+	const float x = p.getX(), y = p.getY(), z = p.getZ();
+	const float theta2 = theta * theta;
+	const float eps2 = adoucissement * adoucissement;
+	float ax = 0, ay = 0, az = 0;
+	std::size_t i = 0;
+	while (i < noeuds.size())
+	{
+		const Noeud& noeud = noeuds[i];
+		if (noeud.feuille)
+		{
+			// The body itself is at distance 0 and adds nothing, even with no softening
+			for (std::size_t j = noeud.premier; j < noeud.premier + noeud.nombre; j++)
+			{
+				const float dx = px[j] - x, dy = py[j] - y, dz = pz[j] - z;
+				const float r2 = dx * dx + dy * dy + dz * dz + eps2;
+				const float facteur = r2 > 0 ? pm[j] / (r2 * std::sqrt(r2)) : 0.f;
+				ax += facteur * dx;
+				ay += facteur * dy;
+				az += facteur * dz;
+			}
+			i = noeud.saut;
+			continue;
+		}
+		const float dx = noeud.x - x, dy = noeud.y - y, dz = noeud.z - z;
+		const float d2 = dx * dx + dy * dy + dz * dz;
+		if (noeud.taille * noeud.taille < theta2 * d2)
+		{
+			// Far enough: the whole cell acts from its center of mass
+			const float r2 = d2 + eps2;
+			const float facteur = noeud.masse / (r2 * std::sqrt(r2));
+			ax += facteur * dx;
+			ay += facteur * dy;
+			az += facteur * dz;
+			i = noeud.saut;
+		}
+		else
+			i++;
+	}
+	return { ax * constante, ay * constante, az * constante };
+}
+
+void BarnesHut::forces(float* FX, float* FY, float* FZ, float constante) const
+{
+	// In Morton order, neighbouring bodies open the same cells
+	MathLib::parallel_for(0, size(), 256, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t k = first; k < last; k++)
+		{
+			const FVector3 a = acceleration(FVector3(px[k], py[k], pz[k]), constante);
+			const std::uint32_t i = ordre[k];
+			FX[i] += pm[k] * a.getX();
+			FY[i] += pm[k] * a.getY();
+			FZ[i] += pm[k] * a.getZ();
+		}
+	});
+}
+
+void BarnesHut::forcesDirectes(const float* X, const float* Y, const float* Z, const float* masses, std::size_t n,
+	float* FX, float* FY, float* FZ, float constante, float adoucissement)
+{
+	const float eps2 = adoucissement * adoucissement;
+	MathLib::parallel_for(0, n, 64, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			float ax = 0, ay = 0, az = 0;
+			for (std::size_t j = 0; j < n; j++)
+			{
+				const float dx = X[j] - X[i], dy = Y[j] - Y[i], dz = Z[j] - Z[i];
+				const float r2 = dx * dx + dy * dy + dz * dz + eps2;
+				const float facteur = r2 > 0 ? masses[j] / (r2 * std::sqrt(r2)) : 0.f;
+				ax += facteur * dx;
+				ay += facteur * dy;
+				az += facteur * dz;
+			}
+			FX[i] += constante * masses[i] * ax;
+			FY[i] += constante * masses[i] * ay;
+			FZ[i] += constante * masses[i] * az;
+		}
+	});
+}
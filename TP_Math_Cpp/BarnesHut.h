@@ -0,0 +1,81 @@
+#pragma once
+
+#include "FVector3.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Mutual gravitation of many bodies in O(N log N) with the Barnes-Hut octree
+ * A cell seen under a small enough angle (its size over its distance below theta) acts as a single body at its center
+ * of mass, only the close cells are opened. theta = 0 gives back the exact sum over every pair.
+ * The bodies are sorted along a Morton curve, so every cell holds a contiguous range of them, and the cells are stored
+ * depth first with the index of the cell following their subtree: the traversal is a loop over an array, with no stack
+ */
+class BarnesHut
+{
+public:
+	// Gravitational constant in SI units
+	static constexpr float CONSTANTE_GRAVITATION = 6.674e-11f;
+	// Largest number of bodies of a leaf, summed one by one
+	static constexpr std::size_t FEUILLE = 8;
+
+	/**
+	 * @param theta : Opening angle, 0.5 is the usual compromise between speed and accuracy
+	 * @param adoucissement : Softening length, the distances are taken as sqrt(r^2 + adoucissement^2)
+	 */
+	explicit BarnesHut(float theta = 0.5f, float adoucissement = 1e-3f);
+
+	void setTheta(float theta) { this->theta = theta; }
+	float getTheta() const { return theta; }
+
+	/**
+	 * Build the tree of a set of bodies, the subtrees of the 64 cells of the second level are built in parallel
+	 * @param X, Y, Z : Positions of the n bodies
+	 * @param masses : Their masses
+	 * @param n : Number of bodies
+	 */
+	void construire(const float* X, const float* Y, const float* Z, const float* masses, std::size_t n);
+
+	// Gravitational acceleration at the point p created by the bodies of the tree
+	FVector3 acceleration(const FVector3& p, float constante = CONSTANTE_GRAVITATION) const;
+	// Add the gravitational force on each body of the tree to FX, FY and FZ (in the order given to construire), in parallel
+	void forces(float* FX, float* FY, float* FZ, float constante = CONSTANTE_GRAVITATION) const;
+
+	std::size_t size() const { return ordre.size(); }
+	std::size_t getNoeuds() const { return noeuds.size(); }
+
+	// Same forces summed over every pair, O(N^2), to measure the error of the tree
+	static void forcesDirectes(const float* X, const float* Y, const float* Z, const float* masses, std::size_t n,
+		float* FX, float* FY, float* FZ, float constante = CONSTANTE_GRAVITATION, float adoucissement = 1e-3f);
+
+private:
+	// Cell of the octree
+	struct Noeud
+	{
+		float x, y, z;          // Center of mass
+		float masse;
+		float taille;           // Side of the cell
+		std::uint32_t premier;  // First body of the cell
+		std::uint32_t nombre;   // Number of bodies, summed directly when the cell is a leaf
+		std::uint32_t saut;     // Next cell once this one and its subtree are done
+		bool feuille;
+	};
+
+	/**
+	 * Append the subtree of the bodies [first, last[ in depth first order
+	 * @param sortie : Cells, the indices are relative to the start of this array
+	 * @param sousArbres : Subtrees of the second level already built, or nullptr to build everything here
+	 */
+	void construireNoeud(std::vector<Noeud>& sortie, std::size_t first, std::size_t last, int niveau,
+		const std::vector<std::vector<Noeud>>* sousArbres) const;
+
+	float theta;
+	float adoucissement;
+	float taille = 0;                 // Side of the root cell
+	std::vector<std::uint64_t> codes; // Morton code of each sorted body
+	std::vector<float> px, py, pz, pm; // Sorted bodies
+	std::vector<std::uint32_t> ordre; // Index given to construire of each sorted body
+	std::vector<Noeud> noeuds;
+};
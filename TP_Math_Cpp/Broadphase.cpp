@@ -0,0 +1,379 @@
+#include "Broadphase.h"
+
+#include "Moments.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+	constexpr float INFINI = std::numeric_limits<float>::max();
+
+	// Box containing nothing, neutral for the union
+	constexpr AABB VIDE = { { INFINI, INFINI, INFINI }, { -INFINI, -INFINI, -INFINI } };
+
+	AABB unir(const AABB& a, const AABB& b)
+	{
+		return { { std::min(a.min[0], b.min[0]), std::min(a.min[1], b.min[1]), std::min(a.min[2], b.min[2]) },
+			{ std::max(a.max[0], b.max[0]), std::max(a.max[1], b.max[1]), std::max(a.max[2], b.max[2]) } };
+	}
+
+	/**
+	 * Eigen vectors of a symmetric 3x3 matrix by Jacobi rotations
+	 * @param a : Matrix, diagonal on return
+	 * @param v : Eigen vectors as columns
+	 */
+	void diagonaliser(double a[3][3], double v[3][3])
+	{
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				v[i][j] = i == j;
+		for (int balayage = 0; balayage < 50; balayage++)
+		{
+			const double horsDiagonale = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+			const double diagonale = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+			if (horsDiagonale <= 1e-24 * diagonale)
+				return;
+			for (int p = 0; p < 2; p++)
+				for (int q = p + 1; q < 3; q++)
+				{
+					if (a[p][q] == 0)
+						continue;
+					// Rotation in the plane (p, q) cancelling a[p][q], the smaller of the two angles
+					const double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+					const double t = (theta >= 0 ? 1 : -1) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+					const double c = 1 / std::sqrt(t * t + 1);
+					const double s = t * c;
+					for (int k = 0; k < 3; k++)
+					{
+						const double akp = a[k][p], akq = a[k][q];
+						a[k][p] = c * akp - s * akq;
+						a[k][q] = s * akp + c * akq;
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						const double apk = a[p][k], aqk = a[q][k];
+						a[p][k] = c * apk - s * aqk;
+						a[q][k] = s * apk + c * aqk;
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						const double vkp = v[k][p], vkq = v[k][q];
+						v[k][p] = c * vkp - s * vkq;
+						v[k][q] = s * vkp + c * vkq;
+					}
+				}
+		}
+	}
+
+	// Bias of the cell coordinates, packed on 21 bits each
+	constexpr std::int64_t BIAIS = std::int64_t(1) << 20;
+
+	// Key of a cell, far away cells may share a key, they are then simply one cell
+	std::uint64_t cleCellule(std::int64_t x, std::int64_t y, std::int64_t z)
+	{
+		constexpr std::uint64_t masque = (std::uint64_t(1) << 21) - 1;
+		return (static_cast<std::uint64_t>(x + BIAIS) & masque) << 42 | (static_cast<std::uint64_t>(y + BIAIS) & masque) << 21
+			| (static_cast<std::uint64_t>(z + BIAIS) & masque);
+	}
+}
+
+AABB AABB::englobant(const Matrix& W)
+{
+	if (W.getRows() != 3 || W.getCols() == 0)
+		throw std::invalid_argument("The solid matrix must be 3xN with at least one point");
+	const float* X = W[0];
+	const float* Y = W[1];
+	const float* Z = W[2];
+	return MathLib::parallel_reduce(0, W.getCols(), 1 << 14, VIDE, [&](std::size_t first, std::size_t last)
+	{
+		AABB boite = VIDE;
+		for (std::size_t i = first; i < last; i++)
+		{
+			boite.min[0] = std::min(boite.min[0], X[i]);
+			boite.min[1] = std::min(boite.min[1], Y[i]);
+			boite.min[2] = std::min(boite.min[2], Z[i]);
+			boite.max[0] = std::max(boite.max[0], X[i]);
+			boite.max[1] = std::max(boite.max[1], Y[i]);
+			boite.max[2] = std::max(boite.max[2], Z[i]);
+		}
+		return boite;
+	}, unir);
+}
+
+OBB OBB::principal(const Matrix& W)
+{
+	if (W.getRows() != 3 || W.getCols() == 0)
+		throw std::invalid_argument("The solid matrix must be 3xN with at least one point");
+	const float* X = W[0];
+	const float* Y = W[1];
+	const float* Z = W[2];
+	const std::size_t n = W.getCols();
+
+	// Covariance of the points, its eigen vectors are the principal axes of inertia
+	const Moments m = MathLib::parallel_reduce(0, n, Moments::BLOC, Moments(),
+		[&](std::size_t first, std::size_t last) { return Moments::bloc(X + first, Y + first, Z + first, last - first); },
+		[](const Moments& a, const Moments& b) { return a + b; });
+	const double cx = m.sx / m.n, cy = m.sy / m.n, cz = m.sz / m.n;
+	double covariance[3][3] = {
+		{ m.sxx / m.n - cx * cx, m.sxy / m.n - cx * cy, m.sxz / m.n - cx * cz },
+		{ m.sxy / m.n - cx * cy, m.syy / m.n - cy * cy, m.syz / m.n - cy * cz },
+		{ m.sxz / m.n - cx * cz, m.syz / m.n - cy * cz, m.szz / m.n - cz * cz } };
+	double v[3][3];
+	diagonaliser(covariance, v);
+	// Keep a direct frame, the box is then moved by a rotation
+	const double determinant = v[0][0] * (v[1][1] * v[2][2] - v[1][2] * v[2][1]) - v[0][1] * (v[1][0] * v[2][2] - v[1][2] * v[2][0])
+		+ v[0][2] * (v[1][0] * v[2][1] - v[1][1] * v[2][0]);
+	if (determinant < 0)
+		for (int i = 0; i < 3; i++)
+			v[i][2] = -v[i][2];
+
+	OBB obb;
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			obb.axes[i][j] = static_cast<float>(v[i][j]);
+
+	// Extent of the points along each axis, measured from the mean
+	const FVector3 moyenne(static_cast<float>(cx), static_cast<float>(cy), static_cast<float>(cz));
+	const FMatrix3& A = obb.axes;
+	const AABB etendue = MathLib::parallel_reduce(0, n, 1 << 14, VIDE, [&](std::size_t first, std::size_t last)
+	{
+		AABB boite = VIDE;
+		for (std::size_t i = first; i < last; i++)
+		{
+			const float px = X[i] - moyenne.getX(), py = Y[i] - moyenne.getY(), pz = Z[i] - moyenne.getZ();
+			for (int k = 0; k < 3; k++)
+			{
+				const float projection = A[0][k] * px + A[1][k] * py + A[2][k] * pz;
+				boite.min[k] = std::min(boite.min[k], projection);
+				boite.max[k] = std::max(boite.max[k], projection);
+			}
+		}
+		return boite;
+	}, unir);
+	obb.centre = moyenne + A * etendue.centre();
+	obb.demiCotes = FVector3(etendue.max[0] - etendue.min[0], etendue.max[1] - etendue.min[1], etendue.max[2] - etendue.min[2]) / 2;
+	return obb;
+}
+
+AABB OBB::aabb(const FMatrix3& R, const FVector3& C, const FVector3& D) const
+{
+	const FVector3 c = R * (centre - C) + D;
+	const FMatrix3 M = R * axes;
+	const float centres[3] = { c.getX(), c.getY(), c.getZ() };
+	const float demi[3] = { demiCotes.getX(), demiCotes.getY(), demiCotes.getZ() };
+	AABB boite;
+	for (int i = 0; i < 3; i++)
+	{
+		const float rayon = std::abs(M[i][0]) * demi[0] + std::abs(M[i][1]) * demi[1] + std::abs(M[i][2]) * demi[2];
+		boite.min[i] = centres[i] - rayon;
+		boite.max[i] = centres[i] + rayon;
+	}
+	return boite;
+}
+
+void SweepAndPrune::mettreAJour(const std::vector<AABB>& boites)
+{
+	if (boites.size() > std::numeric_limits<std::uint32_t>::max())
+		throw std::invalid_argument("Too many boxes");
+	const bool memeCorps = boites.size() == this->boites.size() && !bornes[0].empty();
+	this->boites = boites;
+	if (!memeCorps)
+	{
+		reconstruire();
+		return;
+	}
+
+	// Each axis only reads the boxes and writes its own bounds and events
+	Evenements evenements[3];
+	MathLib::parallel_for(0, 3, 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t axe = first; axe < last; axe++)
+			trierAxe(static_cast<int>(axe), evenements[axe]);
+	});
+
+	// An insertion sort swaps every inverted couple of bounds once, so a pair ending on an axis is separated at the
+	// end of the update and the order of the axes does not matter
+	echanges = 0;
+	for (const Evenements& e : evenements)
+	{
+		echanges += e.echanges;
+		for (const std::uint64_t paire : e.fins)
+			paires.erase(paire);
+	}
+	for (const Evenements& e : evenements)
+		for (const std::uint64_t paire : e.debuts)
+			if (this->boites[paire >> 32].chevauche(this->boites[paire & 0xffffffff]))
+				paires.insert(paire);
+}
+
+void SweepAndPrune::reconstruire()
+{
+	const auto n = static_cast<std::uint32_t>(boites.size());
+	MathLib::parallel_for(0, 3, 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t axe = first; axe < last; axe++)
+		{
+			std::vector<Borne>& b = bornes[axe];
+			b.clear();
+			b.reserve(2 * std::size_t(n));
+			for (std::uint32_t i = 0; i < n; i++)
+			{
+				b.push_back({ boites[i].min[axe], i, false });
+				b.push_back({ boites[i].max[axe], i, true });
+			}
+			std::sort(b.begin(), b.end());
+		}
+	});
+
+	// One sweep along X, the boxes open at a lower bound are tested on the three axes
+	paires.clear();
+	echanges = 0;
+	std::vector<std::uint32_t> actifs;
+	std::vector<std::uint32_t> position(n);
+	for (const Borne& borne : bornes[0])
+	{
+		if (borne.maximum)
+		{
+			// Swap with the last active box
+			const std::uint32_t p = position[borne.corps];
+			actifs[p] = actifs.back();
+			position[actifs[p]] = p;
+			actifs.pop_back();
+			continue;
+		}
+		for (const std::uint32_t autre : actifs)
+			if (boites[borne.corps].chevauche(boites[autre]))
+				paires.insert(cle(borne.corps, autre));
+		position[borne.corps] = static_cast<std::uint32_t>(actifs.size());
+		actifs.push_back(borne.corps);
+	}
+}
+
+void SweepAndPrune::trierAxe(int axe, Evenements& evenements)
+{
+	std::vector<Borne>& b = bornes[axe];
+	for (Borne& borne : b)
+		borne.valeur = borne.maximum ? boites[borne.corps].max[axe] : boites[borne.corps].min[axe];
+
+	for (std::size_t i = 1; i < b.size(); i++)
+	{
+		const Borne borne = b[i];
+		std::size_t j = i;
+		while (j > 0 && borne < b[j - 1])
+		{
+			// The bound passes the one of another box: a lower bound before an upper one starts an overlap, the
+			// opposite ends it
+			const Borne& autre = b[j - 1];
+			if (autre.corps != borne.corps)
+			{
+				if (!borne.maximum && autre.maximum)
+					evenements.debuts.push_back(cle(borne.corps, autre.corps));
+				else if (borne.maximum && !autre.maximum)
+					evenements.fins.push_back(cle(borne.corps, autre.corps));
+			}
+			b[j] = autre;
+			j--;
+			evenements.echanges++;
+		}
+		b[j] = borne;
+	}
+}
+
+std::vector<PaireCandidate> SweepAndPrune::getPaires() const
+{
+	std::vector<PaireCandidate> resultat;
+	resultat.reserve(paires.size());
+	for (const std::uint64_t paire : paires)
+		resultat.emplace_back(static_cast<std::uint32_t>(paire >> 32), static_cast<std::uint32_t>(paire & 0xffffffff));
+	std::sort(resultat.begin(), resultat.end());
+	return resultat;
+}
+
+UniformGrid::UniformGrid(float cellule)
+	: cellule(cellule)
+{
+	if (!(cellule > 0))
+		throw std::invalid_argument("The cell size must be positive");
+}
+
+std::vector<PaireCandidate> UniformGrid::paires(const std::vector<AABB>& boites) const
+{
+	if (boites.size() > std::numeric_limits<std::uint32_t>::max())
+		throw std::invalid_argument("Too many boxes");
+	const std::size_t n = boites.size();
+	const float inverse = 1 / cellule;
+	const auto coordonnee = [inverse](float x) { return static_cast<std::int64_t>(std::floor(x * inverse)); };
+
+	// Number of cells covered by each box, then their offsets in the list of entries
+	std::vector<std::size_t> debuts(n + 1, 0);
+	MathLib::parallel_for(0, n, 1 << 12, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			std::size_t cellules = 1;
+			for (int k = 0; k < 3; k++)
+				cellules *= static_cast<std::size_t>(coordonnee(boites[i].max[k]) - coordonnee(boites[i].min[k]) + 1);
+			debuts[i + 1] = cellules;
+		}
+	});
+	for (std::size_t i = 0; i < n; i++)
+		debuts[i + 1] += debuts[i];
+
+	// (cell, body) entries, sorted so the bodies of a cell follow each other in increasing order
+	std::vector<std::pair<std::uint64_t, std::uint32_t>> entrees(debuts[n]);
+	MathLib::parallel_for(0, n, 1 << 12, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			const AABB& b = boites[i];
+			std::size_t e = debuts[i];
+			for (std::int64_t x = coordonnee(b.min[0]); x <= coordonnee(b.max[0]); x++)
+				for (std::int64_t y = coordonnee(b.min[1]); y <= coordonnee(b.max[1]); y++)
+					for (std::int64_t z = coordonnee(b.min[2]); z <= coordonnee(b.max[2]); z++)
+						entrees[e++] = { cleCellule(x, y, z), static_cast<std::uint32_t>(i) };
+		}
+	});
+	std::sort(entrees.begin(), entrees.end());
+
+	std::vector<std::size_t> groupes;
+	for (std::size_t e = 0; e < entrees.size(); e++)
+		if (e == 0 || entrees[e].first != entrees[e - 1].first)
+			groupes.push_back(e);
+	groupes.push_back(entrees.size());
+
+	// A pair sharing several cells is only kept in the cell holding the lower corner of the intersection of the boxes
+	std::vector<PaireCandidate> resultat = MathLib::parallel_reduce(0, groupes.size() - 1, 64, std::vector<PaireCandidate>(),
+		[&](std::size_t first, std::size_t last)
+	{
+		std::vector<PaireCandidate> local;
+		for (std::size_t g = first; g < last; g++)
+			for (std::size_t a = groupes[g]; a < groupes[g + 1]; a++)
+				for (std::size_t b = a + 1; b < groupes[g + 1]; b++)
+				{
+					const AABB& A = boites[entrees[a].second];
+					const AABB& B = boites[entrees[b].second];
+					if (!A.chevauche(B))
+						continue;
+					const std::uint64_t coin = cleCellule(coordonnee(std::max(A.min[0], B.min[0])),
+						coordonnee(std::max(A.min[1], B.min[1])), coordonnee(std::max(A.min[2], B.min[2])));
+					if (coin == entrees[a].first)
+						local.emplace_back(entrees[a].second, entrees[b].second);
+				}
+		return local;
+	}, [](const std::vector<PaireCandidate>& a, const std::vector<PaireCandidate>& b)
+	{
+		std::vector<PaireCandidate> somme;
+		somme.reserve(a.size() + b.size());
+		somme.insert(somme.end(), a.begin(), a.end());
+		somme.insert(somme.end(), b.begin(), b.end());
+		return somme;
+	});
+	// Far cells sharing a key may give a pair twice
+	std::sort(resultat.begin(), resultat.end());
+	resultat.erase(std::unique(resultat.begin(), resultat.end()), resultat.end());
+	return resultat;
+}
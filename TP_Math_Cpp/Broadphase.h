@@ -0,0 +1,149 @@
+#pragma once
+
+#include "FMatrix3.h"
+#include "FVector3.h"
+#include "Matrix.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Pair of bodies whose boxes overlap, first < second, to be checked by an exact (narrowphase) test
+using PaireCandidate = std::pair<std::uint32_t, std::uint32_t>;
+
+/**
+ * Axis aligned bounding box, the bounds are included so boxes that touch overlap
+ */
+struct AABB
+{
+	float min[3];
+	float max[3];
+
+	bool chevauche(const AABB& other) const
+	{
+		return min[0] <= other.max[0] && other.min[0] <= max[0]
+			&& min[1] <= other.max[1] && other.min[1] <= max[1]
+			&& min[2] <= other.max[2] && other.min[2] <= max[2];
+	}
+
+	// Box grown by marge on every side
+	AABB elargi(float marge) const
+	{
+		return { { min[0] - marge, min[1] - marge, min[2] - marge }, { max[0] + marge, max[1] + marge, max[2] + marge } };
+	}
+
+	FVector3 centre() const { return { (min[0] + max[0]) / 2, (min[1] + max[1]) / 2, (min[2] + max[2]) / 2 }; }
+
+	// Box of the points of a solid matrix, reduced in parallel
+	static AABB englobant(const Matrix& W);
+};
+
+/**
+ * Box oriented along the principal axes of a solid, in its own frame
+ * Built once from the points, it gives the world AABB of every later orientation in O(1), without going over the points
+ */
+struct OBB
+{
+	FVector3 centre;      // Center of the box in the frame of the points
+	FMatrix3 axes;        // Principal axes as columns, a rotation
+	FVector3 demiCotes;   // Half sides along each axis
+
+	/**
+	 * Smallest box along the principal axes of inertia of the points
+	 * @param W : Solid matrix
+	 * @return : Box in the frame of W
+	 */
+	static OBB principal(const Matrix& W);
+
+	/**
+	 * World box of the solid once moved by p -> R * (p - C) + D, the move of MathLib::transforme_points
+	 * The rotated box is enclosed in an AABB of half sides |R axes| demiCotes, slightly larger than the box of the points
+	 */
+	AABB aabb(const FMatrix3& R, const FVector3& C, const FVector3& D) const;
+};
+
+/**
+ * Incremental sweep and prune over the three axes
+ * The bounds of the boxes are kept sorted on each axis from one update to the next. Bodies move little between two
+ * steps, so an insertion sort puts them back in order in close to linear time, and every swap of a lower bound with
+ * an upper bound is exactly a pair starting or ending to overlap on that axis: the pairs are updated from the swaps,
+ * never searched from scratch
+ */
+class SweepAndPrune
+{
+public:
+	/**
+	 * Move the boxes and update the overlapping pairs, the three axes are sorted in parallel
+	 * A different number of boxes starts over with a full sort
+	 * @param boites : Box of each body
+	 */
+	void mettreAJour(const std::vector<AABB>& boites);
+
+	// Overlapping pairs, sorted
+	std::vector<PaireCandidate> getPaires() const;
+	std::size_t getNombrePaires() const { return paires.size(); }
+	// Number of swaps of the last update, about the work it did
+	std::size_t getEchanges() const { return echanges; }
+
+private:
+	// Bound of a box on one axis
+	struct Borne
+	{
+		float valeur;
+		std::uint32_t corps;
+		bool maximum;
+
+		// At equal values the lower bound comes first, touching boxes overlap
+		bool operator<(const Borne& other) const
+		{
+			return valeur < other.valeur || (valeur == other.valeur && !maximum && other.maximum);
+		}
+	};
+
+	// Changes of the pairs seen while sorting one axis
+	struct Evenements
+	{
+		std::vector<std::uint64_t> debuts;  // Pairs starting to overlap on the axis, kept if they overlap on all three
+		std::vector<std::uint64_t> fins;    // Pairs no longer overlapping
+		std::size_t echanges = 0;
+	};
+
+	void reconstruire();
+	void trierAxe(int axe, Evenements& evenements);
+
+	static std::uint64_t cle(std::uint32_t a, std::uint32_t b)
+	{
+		return a < b ? (std::uint64_t(a) << 32 | b) : (std::uint64_t(b) << 32 | a);
+	}
+
+	std::vector<AABB> boites;
+	std::vector<Borne> bornes[3];
+	std::unordered_set<std::uint64_t> paires;
+	std::size_t echanges = 0;
+};
+
+/**
+ * Uniform grid for many bodies of about the same size
+ * Each box goes into every cell it covers, with cells at least as large as the boxes that is at most 8,
+ * and only the bodies sharing a cell are compared. The grid is built again at each call, from a sort of the cells
+ */
+class UniformGrid
+{
+public:
+	// @param cellule : Side of a cell, about the size of the largest body
+	explicit UniformGrid(float cellule);
+
+	float getCellule() const { return cellule; }
+
+	/**
+	 * Overlapping pairs of boxes, computed in parallel
+	 * @param boites : Box of each body
+	 * @return : Pairs, sorted
+	 */
+	std::vector<PaireCandidate> paires(const std::vector<AABB>& boites) const;
+
+private:
+	float cellule;
+};
@@ -0,0 +1,42 @@
+#include "Ensemble.h"
+
+void EnsembleStatistiques::fusionner(const EnsembleStatistiques& other)
+{
+	for (std::size_t t = 0; t < valeurs.size(); ++t)
+		for (std::size_t k = 0; k < valeurs[t].size(); ++k)
+			valeurs[t][k].fusionner(other.valeurs[t][k]);
+}
+
+FQuaternion EnsembleStatistiques::orientationMoyenne(std::size_t t) const
+{
+	const FVector3 moyenne(static_cast<float>(rotation(t, 0).moyenne), static_cast<float>(rotation(t, 1).moyenne),
+		static_cast<float>(rotation(t, 2).moyenne));
+	return (references[t] * FQuaternion::exp(moyenne)).normalized();
+}
+
+void EnsembleSink::recevoir(const Pose& pose)
+{
+	const std::size_t t = index++;
+	auto& valeurs = statistiques.valeurs[t];
+	const FVector3 rotation = (statistiques.references[t].conjugate() * pose.orientation).log();
+	valeurs[0].ajouter(pose.G.getX());
+	valeurs[1].ajouter(pose.G.getY());
+	valeurs[2].ajouter(pose.G.getZ());
+	valeurs[3].ajouter(rotation.getX());
+	valeurs[4].ajouter(rotation.getY());
+	valeurs[5].ajouter(rotation.getZ());
+}
+
+/**
+ * splitmix64 of the seed of the ensemble and the index of the member
+ * @param graine : Seed of the ensemble
+ * @param i : index of the member
+ * @return : Seed of the member
+ */
+std::uint64_t MathLib::graineMembre(std::uint64_t graine, std::size_t i)
+{
+	std::uint64_t z = graine + 0x9E3779B97F4A7C15ULL * (static_cast<std::uint64_t>(i) + 1);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "FQuaternion.h"
+#include "FrameSink.h"
+#include "FVector3.h"
+#include "Matrix.h"
+#include "Parallel.h"
+#include "RigidBody.h"
+#include "Welford.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * Parameters of one member of an ensemble: the arguments of trace_mouvements but the solid matrix
+ */
+struct EnsembleMembre
+{
+	float m;
+	Matrix I;
+	FVector3 G;
+	FVector3 v;
+	FVector3 teta;
+	FVector3 tetap;
+	std::vector<std::vector<FVector3>> F;
+	std::vector<std::vector<FVector3>> A;
+};
+
+/**
+ * Statistics over the members of an ensemble at each output time
+ * For each time: G along X, Y and Z then the rotation vector log(q_ref^-1 q) of the orientation q relative to a
+ * reference q_ref, the orientation of member 0 at that time. The log of the orientation itself flips its axis once
+ * the angle passes pi, the spread around the reference stays well below it, so the rotation vectors can be averaged
+ */
+struct EnsembleStatistiques
+{
+	std::vector<float> temps;
+	std::vector<FQuaternion> references;
+	std::vector<std::array<Welford, 6>> valeurs;
+
+	void fusionner(const EnsembleStatistiques& other);
+
+	const Welford& G(std::size_t t, int axe) const { return valeurs[t][axe]; }
+	// Rotation from the reference, in the frame of the reference
+	const Welford& rotation(std::size_t t, int axe) const { return valeurs[t][3 + axe]; }
+	// Mean orientation, the reference turned by the mean rotation
+	FQuaternion orientationMoyenne(std::size_t t) const;
+};
+
+/**
+ * Sink adding the frames of one member to the statistics of the ensemble, one frame per output time
+ */
+class EnsembleSink : public FrameSink
+{
+public:
+	explicit EnsembleSink(EnsembleStatistiques& statistiques) : statistiques(statistiques) {}
+
+	void recevoir(const Pose& pose) override;
+
+private:
+	EnsembleStatistiques& statistiques;
+	std::size_t index = 0;
+};
+
+namespace MathLib
+{
+	// Seed of member i of an ensemble, mixed with splitmix64 so neighbouring members get unrelated sequences
+	std::uint64_t graineMembre(std::uint64_t graine, std::size_t i);
+
+	/**
+	 * Run many perturbed motions concurrently and reduce them to statistics per output time
+	 * Members are run by blocks on the thread pool, each block is reduced in member order and the blocks are merged
+	 * pairwise in order, so the statistics only depend on the seed, not on the number of threads.
+	 * Only the statistics are kept, never the trajectories of the members
+	 * @param membres : Number of members
+	 * @param graine : Seed of the ensemble
+	 * @param generateur : callable taking (std::size_t i, std::mt19937_64& rng) and returning the EnsembleMembre i
+	 * @param h : Internal time step
+	 * @param temps : Output times, increasing and positive
+	 * @return : Mean, variance, minimum and maximum of G and of the orientation over the members at each output time
+	 */
+	template<class Generateur>
+	EnsembleStatistiques ensemble(std::size_t membres, std::uint64_t graine, Generateur&& generateur, float h,
+		const std::vector<float>& temps)
+	{
+		// Members reduced by a single task
+		constexpr std::size_t BLOC = 16;
+
+		EnsembleStatistiques vide;
+		vide.temps = temps;
+		vide.valeurs.resize(temps.size());
+		if (membres == 0)
+			return vide;
+
+		const auto lancer = [&](std::size_t i, FrameSink& sink)
+		{
+			std::mt19937_64 rng(graineMembre(graine, i));
+			const EnsembleMembre p = generateur(i, rng);
+			RigidBody corps(Matrix(3, 0), p.m, p.I, p.G, p.v, p.teta, p.tetap);
+			simuler(corps, p.F, p.A, h, temps, sink);
+		};
+
+		// Member 0 is run once more alone for the reference orientations
+		RingBufferSink poses(std::max<std::size_t>(temps.size(), 1));
+		lancer(0, poses);
+		for (std::size_t t = 0; t < poses.size(); ++t)
+			vide.references.push_back(poses[t].orientation);
+
+		return parallel_reduce(0, membres, BLOC, vide, [&](std::size_t first, std::size_t last)
+		{
+			EnsembleStatistiques statistiques = vide;
+			for (std::size_t i = first; i < last; ++i)
+			{
+				EnsembleSink sink(statistiques);
+				lancer(i, sink);
+			}
+			return statistiques;
+		}, [](const EnsembleStatistiques& a, const EnsembleStatistiques& b)
+		{
+			EnsembleStatistiques somme = a;
+			somme.fusionner(b);
+			return somme;
+		});
+	}
+}
@@ -0,0 +1,30 @@
+#include "FMatrix3.h"
+
+#include "Matrix.h"
+
+#include <sstream>
+
+Matrix FMatrix3::toMatrix() const
+{
+	Matrix m(3, 3);
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			m[i][j] = data[i][j];
+	return m;
+}
+
+FMatrix3 FMatrix3::fromMatrix(const Matrix& m)
+{
+	if (m.getRows() != 3 || m.getCols() != 3)
+		throw std::invalid_argument("Matrix must be 3x3");
+	FMatrix3 result;
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			result.data[i][j] = m[i][j];
+	return result;
+}
+
+std::string FMatrix3::ToString() const
+{
+	return toMatrix().ToString();
+}
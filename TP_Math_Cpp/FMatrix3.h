@@ -0,0 +1,119 @@
+#pragma once
+
+#include "FVector3.h"
+
+#include <stdexcept>
+#include <string>
+
+class Matrix;
+
+/**
+ * Class to represent a fixed 3x3 matrix with float values
+ * Unlike Matrix, it lives on the stack and every operation is constexpr
+ */
+class FMatrix3
+{
+public:
+	constexpr FMatrix3() : data{} {}
+	constexpr FMatrix3(float m00, float m01, float m02,
+	                   float m10, float m11, float m12,
+	                   float m20, float m21, float m22)
+		: data{ {m00, m01, m02}, {m10, m11, m12}, {m20, m21, m22} }
+	{
+	}
+
+	// Conversion operators
+	constexpr float* operator[](int row) { return data[row]; }
+	constexpr const float* operator[](int row) const { return data[row]; }
+
+	constexpr FMatrix3 operator*(const FMatrix3& other) const
+	{
+		FMatrix3 result;
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				result.data[i][j] = data[i][0] * other.data[0][j] + data[i][1] * other.data[1][j] + data[i][2] * other.data[2][j];
+		return result;
+	}
+
+	constexpr FVector3 operator*(const FVector3& vector) const
+	{
+		return {
+			vector.getX() * data[0][0] + vector.getY() * data[0][1] + vector.getZ() * data[0][2],
+			vector.getX() * data[1][0] + vector.getY() * data[1][1] + vector.getZ() * data[1][2],
+			vector.getX() * data[2][0] + vector.getY() * data[2][1] + vector.getZ() * data[2][2]
+		};
+	}
+
+	constexpr FMatrix3 operator*(float value) const
+	{
+		FMatrix3 result;
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				result.data[i][j] = data[i][j] * value;
+		return result;
+	}
+
+	constexpr FMatrix3 operator+(const FMatrix3& other) const
+	{
+		FMatrix3 result;
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				result.data[i][j] = data[i][j] + other.data[i][j];
+		return result;
+	}
+
+	// Conversions from and to the dynamic Matrix
+	Matrix toMatrix() const;
+	static FMatrix3 fromMatrix(const Matrix& m);
+	std::string ToString() const;
+
+	// Static methods
+	static constexpr FMatrix3 Identity() { return { 1, 0, 0, 0, 1, 0, 0, 0, 1 }; }
+
+	static constexpr FMatrix3 tran(const FMatrix3& m)
+	{
+		return {
+			m[0][0], m[1][0], m[2][0],
+			m[0][1], m[1][1], m[2][1],
+			m[0][2], m[1][2], m[2][2]
+		};
+	}
+
+	// Cross product matrix: skew(u) * v = u x v
+	static constexpr FMatrix3 skew(const FVector3& u)
+	{
+		return {
+			0, -u.getZ(), u.getY(),
+			u.getZ(), 0, -u.getX(),
+			-u.getY(), u.getX(), 0
+		};
+	}
+
+	static constexpr float deter(const FMatrix3& m)
+	{
+		return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+		     - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+		     + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	}
+
+	/**
+	 * Inverse through the transposed comatrix, written out for the 3x3 case
+	 * @param m : Matrix to invert
+	 * @return : Inverse of m
+	 */
+	static constexpr FMatrix3 inverse(const FMatrix3& m)
+	{
+		const float det = deter(m);
+		if (det == 0)
+			throw std::runtime_error("Matrix determinant is zero, cannot compute inverse.");
+		const float invDet = 1 / det;
+		return FMatrix3{
+			m[1][1] * m[2][2] - m[1][2] * m[2][1], m[0][2] * m[2][1] - m[0][1] * m[2][2], m[0][1] * m[1][2] - m[0][2] * m[1][1],
+			m[1][2] * m[2][0] - m[1][0] * m[2][2], m[0][0] * m[2][2] - m[0][2] * m[2][0], m[0][2] * m[1][0] - m[0][0] * m[1][2],
+			m[1][0] * m[2][1] - m[1][1] * m[2][0], m[0][1] * m[2][0] - m[0][0] * m[2][1], m[0][0] * m[1][1] - m[0][1] * m[1][0]
+		} * invDet;
+	}
+
+private:
+	float data[3][3];
+};
@@ -0,0 +1,197 @@
+#include "FQuaternion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+FQuaternion FQuaternion::operator*(const FQuaternion& other) const
+{
+	return {
+		W * other.W - X * other.X - Y * other.Y - Z * other.Z,
+		W * other.X + X * other.W + Y * other.Z - Z * other.Y,
+		W * other.Y - X * other.Z + Y * other.W + Z * other.X,
+		W * other.Z + X * other.Y - Y * other.X + Z * other.W
+	};
+}
+
+FVector3 FQuaternion::operator*(const FVector3& vector) const
+{
+	// v + 2 u x (u x v + w v), with u the vector part
+	const FVector3 u(X, Y, Z);
+	const FVector3 t = FVector3::prodVect(u, vector) * 2.f;
+	return vector + t * W + FVector3::prodVect(u, t);
+}
+
+FQuaternion FQuaternion::conjugate() const
+{
+	return { W, -X, -Y, -Z };
+}
+
+float FQuaternion::dot(const FQuaternion& other) const
+{
+	return W * other.W + X * other.X + Y * other.Y + Z * other.Z;
+}
+
+float FQuaternion::norm() const
+{
+	return std::sqrt(W * W + X * X + Y * Y + Z * Z);
+}
+
+FQuaternion FQuaternion::normalized() const
+{
+	const float n = norm();
+	return { W / n, X / n, Y / n, Z / n };
+}
+
+FMatrix3 FQuaternion::toRotationMatrix() const
+{
+	return {
+		1 - 2 * (Y * Y + Z * Z), 2 * (X * Y - W * Z), 2 * (X * Z + W * Y),
+		2 * (X * Y + W * Z), 1 - 2 * (X * X + Z * Z), 2 * (Y * Z - W * X),
+		2 * (X * Z - W * Y), 2 * (Y * Z + W * X), 1 - 2 * (X * X + Y * Y)
+	};
+}
+
+/**
+ * Angles of the rotation Rz * Ry * Rx
+ * At the gimbal lock (Y angle of +-pi/2) only the sum or the difference of the X and Z angles is defined, Z is then set to 0
+ * @return : Angles around X, Y and Z
+ */
+FVector3 FQuaternion::toEuler() const
+{
+	const FMatrix3 R = toRotationMatrix();
+	const float sY = std::clamp(-R[2][0], -1.f, 1.f);
+	if (std::abs(sY) > 0.99999f)
+		return { std::atan2(sY * R[0][1], R[1][1]), std::asin(sY), 0.f };
+	return { std::atan2(R[2][1], R[2][2]), std::asin(sY), std::atan2(R[1][0], R[0][0]) };
+}
+
+std::string FQuaternion::ToString() const
+{
+	std::ostringstream oss;
+	oss << "W: " << W << ", X: " << X << ", Y: " << Y << ", Z: " << Z;
+	return oss.str();
+}
+
+/**
+ * Quaternion of the rotation Rz * Ry * Rx built by MathLib::matrice_rotation
+ * @param teta : angles around X, Y and Z
+ * @return : The unit quaternion
+ */
+FQuaternion FQuaternion::fromEuler(const FVector3& teta)
+{
+	const float hx = 0.5f * teta.getX();
+	const float hy = 0.5f * teta.getY();
+	const float hz = 0.5f * teta.getZ();
+	const FQuaternion qx(std::cos(hx), std::sin(hx), 0, 0);
+	const FQuaternion qy(std::cos(hy), 0, std::sin(hy), 0);
+	const FQuaternion qz(std::cos(hz), 0, 0, std::sin(hz));
+	return qz * qy * qx;
+}
+
+/**
+ * Quaternion of a rotation matrix, from its largest diagonal term to stay accurate for every angle
+ * @param R : Rotation matrix
+ * @return : The unit quaternion
+ */
+FQuaternion FQuaternion::fromRotationMatrix(const FMatrix3& R)
+{
+	const float trace = R[0][0] + R[1][1] + R[2][2];
+	FQuaternion q;
+	if (trace > 0)
+	{
+		const float s = 2 * std::sqrt(1 + trace);
+		q = { 0.25f * s, (R[2][1] - R[1][2]) / s, (R[0][2] - R[2][0]) / s, (R[1][0] - R[0][1]) / s };
+	}
+	else if (R[0][0] > R[1][1] && R[0][0] > R[2][2])
+	{
+		const float s = 2 * std::sqrt(1 + R[0][0] - R[1][1] - R[2][2]);
+		q = { (R[2][1] - R[1][2]) / s, 0.25f * s, (R[0][1] + R[1][0]) / s, (R[0][2] + R[2][0]) / s };
+	}
+	else if (R[1][1] > R[2][2])
+	{
+		const float s = 2 * std::sqrt(1 + R[1][1] - R[0][0] - R[2][2]);
+		q = { (R[0][2] - R[2][0]) / s, (R[0][1] + R[1][0]) / s, 0.25f * s, (R[1][2] + R[2][1]) / s };
+	}
+	else
+	{
+		const float s = 2 * std::sqrt(1 + R[2][2] - R[0][0] - R[1][1]);
+		q = { (R[1][0] - R[0][1]) / s, (R[0][2] + R[2][0]) / s, (R[1][2] + R[2][1]) / s, 0.25f * s };
+	}
+	return q.normalized();
+}
+
+/**
+ * Exponential map: rotation of angle |r| around the axis r / |r|
+ * @param r : Rotation vector, typically the angular speed times the time step
+ * @return : The unit quaternion
+ */
+FQuaternion FQuaternion::exp(const FVector3& r)
+{
+	const float angle = std::sqrt(r.getX() * r.getX() + r.getY() * r.getY() + r.getZ() * r.getZ());
+	float w, s;
+	if (angle < 1e-4f)
+	{
+		// Taylor series of cos(a/2) and sin(a/2)/a, exact to float precision for small angles
+		w = 1 - angle * angle / 8;
+		s = 0.5f - angle * angle / 48;
+	}
+	else
+	{
+		w = std::cos(0.5f * angle);
+		s = std::sin(0.5f * angle) / angle;
+	}
+	return { w, r.getX() * s, r.getY() * s, r.getZ() * s };
+}
+
+/**
+ * Logarithmic map, the rotation vector whose exponential is this rotation
+ * q and -q are the same rotation, the one with W >= 0 gives the shortest angle
+ * @return : Axis of the rotation scaled by its angle, in [0, pi]
+ */
+FVector3 FQuaternion::log() const
+{
+	const float signe = W < 0 ? -1.f : 1.f;
+	const FVector3 u(X * signe, Y * signe, Z * signe);
+	const float s = std::sqrt(X * X + Y * Y + Z * Z);
+	// Small angles: sin(a/2) ~ a/2
+	if (s < 1e-6f)
+		return u * 2.f;
+	return u * (2.f * std::atan2(s, W * signe) / s);
+}
+
+/**
+ * Spherical linear interpolation
+ * @param a : Rotation at u = 0
+ * @param b : Rotation at u = 1
+ * @param u : Position between a and b, in [0, 1]
+ * @param plusCourt : Take -b when it is closer to a, false for squad whose keys are already aligned
+ * @return : The interpolated unit quaternion
+ */
+FQuaternion FQuaternion::slerp(const FQuaternion& a, const FQuaternion& b, float u, bool plusCourt)
+{
+	float d = a.dot(b);
+	const float signe = plusCourt && d < 0 ? -1.f : 1.f;
+	d *= signe;
+	float wa, wb;
+	// Close rotations: sin(angle) vanishes, the linear interpolation is exact to float precision
+	if (d > 0.9995f)
+	{
+		wa = 1 - u;
+		wb = u;
+	}
+	else
+	{
+		const float angle = std::acos(std::max(-1.f, d));
+		const float sinus = std::sin(angle);
+		wa = std::sin((1 - u) * angle) / sinus;
+		wb = std::sin(u * angle) / sinus;
+	}
+	wb *= signe;
+	return FQuaternion(wa * a.W + wb * b.W, wa * a.X + wb * b.X, wa * a.Y + wb * b.Y, wa * a.Z + wb * b.Z).normalized();
+}
+
+FQuaternion FQuaternion::squad(const FQuaternion& q1, const FQuaternion& q2, const FQuaternion& s1, const FQuaternion& s2, float u)
+{
+	return slerp(slerp(q1, q2, u, false), slerp(s1, s2, u, false), 2 * u * (1 - u), false);
+}
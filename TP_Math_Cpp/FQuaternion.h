@@ -0,0 +1,57 @@
+#pragma once
+
+#include "FMatrix3.h"
+#include "FVector3.h"
+
+#include <string>
+
+/**
+ * Class to represent a rotation as a unit quaternion W + X i + Y j + Z k
+ * Unlike the angular vector teta, composing two rotations is exact and the angles never grow without bound
+ */
+class FQuaternion
+{
+public:
+	constexpr FQuaternion() : W(1), X(0), Y(0), Z(0) {}
+	constexpr FQuaternion(float W, float X, float Y, float Z) : W(W), X(X), Y(Y), Z(Z) {}
+
+	// Hamilton product, q1 * q2 applies q2 then q1
+	FQuaternion operator*(const FQuaternion& other) const;
+	// Rotate a vector
+	FVector3 operator*(const FVector3& vector) const;
+
+	FQuaternion conjugate() const;
+	float dot(const FQuaternion& other) const;
+	float norm() const;
+	FQuaternion normalized() const;
+
+	// Rotation matrix, and the angles around X, Y and Z of MathLib::matrice_rotation, each in [-pi, pi]
+	FMatrix3 toRotationMatrix() const;
+	FVector3 toEuler() const;
+
+	std::string ToString() const;
+
+	static FQuaternion fromEuler(const FVector3& teta);
+	static FQuaternion fromRotationMatrix(const FMatrix3& R);
+	// Rotation of angle |r| around r / |r| (exponential map)
+	static FQuaternion exp(const FVector3& r);
+	// Inverse of exp: rotation vector of angle in [0, pi]
+	FVector3 log() const;
+
+	// Constant speed rotation from a (u = 0) to b (u = 1), by the shortest way unless plusCourt is false
+	static FQuaternion slerp(const FQuaternion& a, const FQuaternion& b, float u, bool plusCourt = true);
+	// Spherical cubic from q1 to q2, s1 and s2 are their tangents q exp(-(log(q^-1 next) + log(q^-1 previous)) / 4)
+	static FQuaternion squad(const FQuaternion& q1, const FQuaternion& q2, const FQuaternion& s1, const FQuaternion& s2, float u);
+
+	// Getters
+	constexpr float getW() const { return W; }
+	constexpr float getX() const { return X; }
+	constexpr float getY() const { return Y; }
+	constexpr float getZ() const { return Z; }
+
+private:
+	float W;
+	float X;
+	float Y;
+	float Z;
+};
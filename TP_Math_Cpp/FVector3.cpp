@@ -3,16 +3,6 @@
 #include <cmath>
 #include "Matrix.h"
 
-FVector3::FVector3()
-	: X(0), Y(0), Z(0)
-{
-}
-
-FVector3::FVector3(float X, float Y, float Z)
-	: X(X), Y(Y), Z(Z)
-{
-}
-
 FVector3& FVector3::operator=(const FVector3& other) {
 	if (this != &other) {
 		X = other.X;
@@ -11,10 +11,10 @@ class Matrix;
 class FVector3
 {
 public:
-	FVector3();
-	FVector3(float X, float Y, float Z);
-	FVector3(const FVector3& other) = default;
-	virtual ~FVector3() = default;
+	constexpr FVector3() : X(0), Y(0), Z(0) {}
+	constexpr FVector3(float X, float Y, float Z) : X(X), Y(Y), Z(Z) {}
+	constexpr FVector3(const FVector3& other) = default;
+	~FVector3() = default;
 
 	// Conversion operators
 	FVector3& operator=(const FVector3& other);
@@ -28,16 +28,16 @@ public:
 
 	std::string ToString() const;
 
-	static FVector3 Zero() { return FVector3(0, 0, 0); }
+	static constexpr FVector3 Zero() { return FVector3(0, 0, 0); }
 
 	static FVector3 distance(const FVector3& u, const FVector3& v);
 	static FVector3 prodVect(const FVector3& u, const FVector3& v);
 	static FVector3 moment(const FVector3& F, const FVector3& A, const FVector3& G);
 
 	// Getters
-	float getX() const { return X; }
-	float getY() const { return Y; }
-	float getZ() const { return Z; }
+	constexpr float getX() const { return X; }
+	constexpr float getY() const { return Y; }
+	constexpr float getZ() const { return Z; }
 
 private:
 	float X;
@@ -0,0 +1,238 @@
+#include "ForceField.h"
+
+#include "Parallel.h"
+#include "TransformPoints.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	// Net force and torque of a set of points, in double like Moments
+	struct Charge
+	{
+		double F[3] = {};
+		double M[3] = {};
+
+		Charge operator+(const Charge& other) const
+		{
+			Charge result;
+			for (int k = 0; k < 3; k++)
+			{
+				result.F[k] = F[k] + other.F[k];
+				result.M[k] = M[k] + other.M[k];
+			}
+			return result;
+		}
+	};
+
+	// The arrays of a block never overlap: telling the compiler so (restrict) lets it vectorize the loops below
+
+	// Speed of each point, v + omega x (p - G), and forces reset
+	void preparer(std::size_t n, const float* __restrict X, const float* __restrict Y, const float* __restrict Z,
+		const FVector3& G, const FVector3& v, const FVector3& omega, float* __restrict VX, float* __restrict VY,
+		float* __restrict VZ, float* __restrict FX, float* __restrict FY, float* __restrict FZ)
+	{
+		const float gx = G.getX(), gy = G.getY(), gz = G.getZ();
+		const float vx = v.getX(), vy = v.getY(), vz = v.getZ();
+		const float ox = omega.getX(), oy = omega.getY(), oz = omega.getZ();
+		for (std::size_t i = 0; i < n; i++)
+		{
+			const float rx = X[i] - gx;
+			const float ry = Y[i] - gy;
+			const float rz = Z[i] - gz;
+			VX[i] = vx + oy * rz - oz * ry;
+			VY[i] = vy + oz * rx - ox * rz;
+			VZ[i] = vz + ox * ry - oy * rx;
+			FX[i] = 0;
+			FY[i] = 0;
+			FZ[i] = 0;
+		}
+	}
+
+	void ajouterConstante(std::size_t n, float fx, float fy, float fz, float* __restrict FX, float* __restrict FY, float* __restrict FZ)
+	{
+		for (std::size_t i = 0; i < n; i++)
+		{
+			FX[i] += fx;
+			FY[i] += fy;
+			FZ[i] += fz;
+		}
+	}
+
+	void ajouterTrainee(std::size_t n, float k, const FVector3& vent, const float* __restrict VX, const float* __restrict VY,
+		const float* __restrict VZ, float* __restrict FX, float* __restrict FY, float* __restrict FZ)
+	{
+		const float wx = vent.getX(), wy = vent.getY(), wz = vent.getZ();
+		for (std::size_t i = 0; i < n; i++)
+		{
+			FX[i] -= k * (VX[i] - wx);
+			FY[i] -= k * (VY[i] - wy);
+			FZ[i] -= k * (VZ[i] - wz);
+		}
+	}
+
+	// Inverse square law without pow
+	void ajouterRadialCarre(std::size_t n, const FVector3& centre, float k, float eps2, const float* __restrict X,
+		const float* __restrict Y, const float* __restrict Z, float* __restrict FX, float* __restrict FY, float* __restrict FZ)
+	{
+		const float cx = centre.getX(), cy = centre.getY(), cz = centre.getZ();
+		for (std::size_t i = 0; i < n; i++)
+		{
+			const float dx = X[i] - cx;
+			const float dy = Y[i] - cy;
+			const float dz = Z[i] - cz;
+			const float r2 = dx * dx + dy * dy + dz * dz + eps2;
+			const float facteur = k / (r2 * std::sqrt(r2));
+			FX[i] += facteur * dx;
+			FY[i] += facteur * dy;
+			FZ[i] += facteur * dz;
+		}
+	}
+
+	/**
+	 * Evaluate the fields on the points [first, last[ and reduce their forces and moments about G
+	 * The points, their speeds and their forces live in arrays on the stack, the block never allocates
+	 * @param source : Points of the solid
+	 * @param R : Rotation placing the points in the world frame (p = R * source + G), nullptr when they already are
+	 */
+	Charge reduireBloc(const Matrix& source, const FMatrix3* R, const FVector3& G, const FVector3& v, const FVector3& omega,
+		float masse, const std::vector<const ForceField*>& champs, std::size_t first, std::size_t last)
+	{
+		constexpr std::size_t BLOC = ForceField::BLOC;
+		alignas(32) float bufX[BLOC], bufY[BLOC], bufZ[BLOC];
+		alignas(32) float VX[BLOC], VY[BLOC], VZ[BLOC];
+		alignas(32) float FX[BLOC], FY[BLOC], FZ[BLOC];
+		const std::size_t n = last - first;
+
+		const float* X = source[0] + first;
+		const float* Y = source[1] + first;
+		const float* Z = source[2] + first;
+		if (R)
+		{
+			MathLib::transforme_bloc(X, Y, Z, bufX, bufY, bufZ, n, *R, FVector3::Zero(), G);
+			X = bufX;
+			Y = bufY;
+			Z = bufZ;
+		}
+
+		preparer(n, X, Y, Z, G, v, omega, VX, VY, VZ, FX, FY, FZ);
+		const PointsBloc bloc{ X, Y, Z, VX, VY, VZ, masse, n };
+		for (const ForceField* champ : champs)
+			champ->evaluer(bloc, FX, FY, FZ);
+
+		const float gx = G.getX(), gy = G.getY(), gz = G.getZ();
+		// Independent accumulators so the loop maps onto vector registers, combined in a fixed order
+		constexpr int LANES = 4;
+		double sfx[LANES] = {}, sfy[LANES] = {}, sfz[LANES] = {};
+		double smx[LANES] = {}, smy[LANES] = {}, smz[LANES] = {};
+		std::size_t i = 0;
+		for (; i + LANES <= n; i += LANES)
+		{
+			for (int l = 0; l < LANES; l++)
+			{
+				const float rx = X[i + l] - gx;
+				const float ry = Y[i + l] - gy;
+				const float rz = Z[i + l] - gz;
+				const float fx = FX[i + l], fy = FY[i + l], fz = FZ[i + l];
+				sfx[l] += fx;
+				sfy[l] += fy;
+				sfz[l] += fz;
+				smx[l] += ry * fz - rz * fy;
+				smy[l] += rz * fx - rx * fz;
+				smz[l] += rx * fy - ry * fx;
+			}
+		}
+		Charge charge;
+		for (int l = 0; l < LANES; l++)
+		{
+			charge.F[0] += sfx[l];
+			charge.F[1] += sfy[l];
+			charge.F[2] += sfz[l];
+			charge.M[0] += smx[l];
+			charge.M[1] += smy[l];
+			charge.M[2] += smz[l];
+		}
+		for (; i < n; i++)
+		{
+			const float rx = X[i] - gx;
+			const float ry = Y[i] - gy;
+			const float rz = Z[i] - gz;
+			charge.F[0] += FX[i];
+			charge.F[1] += FY[i];
+			charge.F[2] += FZ[i];
+			charge.M[0] += ry * FZ[i] - rz * FY[i];
+			charge.M[1] += rz * FX[i] - rx * FZ[i];
+			charge.M[2] += rx * FY[i] - ry * FX[i];
+		}
+		return charge;
+	}
+
+	DoubleVector3 reduire(const Matrix& source, const FMatrix3* R, const FVector3& G, const FVector3& v, const FVector3& omega,
+		float m, const std::vector<const ForceField*>& champs)
+	{
+		if (source.getCols() > 0 && source.getRows() != 3)
+			throw std::invalid_argument("Solid matrix must have 3 rows");
+		for (const ForceField* champ : champs)
+			if (!champ)
+				throw std::invalid_argument("Null force field");
+		const std::size_t n = source.getCols();
+		if (n == 0 || champs.empty())
+			return { FVector3::Zero(), FVector3::Zero() };
+
+		const float masse = m / static_cast<float>(n);
+		// Fixed blocks merged by a fixed tree: the result does not depend on the number of threads
+		const Charge total = MathLib::parallel_reduce(0, n, ForceField::BLOC, Charge(),
+			[&](std::size_t first, std::size_t last) { return reduireBloc(source, R, G, v, omega, masse, champs, first, last); },
+			[](const Charge& a, const Charge& b) { return a + b; });
+		return {
+			FVector3(static_cast<float>(total.F[0]), static_cast<float>(total.F[1]), static_cast<float>(total.F[2])),
+			FVector3(static_cast<float>(total.M[0]), static_cast<float>(total.M[1]), static_cast<float>(total.M[2]))
+		};
+	}
+}
+
+void GravityField::evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const
+{
+	ajouterConstante(bloc.n, g.getX() * bloc.masse, g.getY() * bloc.masse, g.getZ() * bloc.masse, FX, FY, FZ);
+}
+
+void DragField::evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const
+{
+	ajouterTrainee(bloc.n, k, vent, bloc.VX, bloc.VY, bloc.VZ, FX, FY, FZ);
+}
+
+void RadialField::evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const
+{
+	const float eps2 = adoucissement * adoucissement;
+	const float k = intensite * bloc.masse;
+	if (puissance == 2.f)
+	{
+		ajouterRadialCarre(bloc.n, centre, k, eps2, bloc.X, bloc.Y, bloc.Z, FX, FY, FZ);
+		return;
+	}
+	const float exposant = -0.5f * (puissance + 1);
+	for (std::size_t i = 0; i < bloc.n; i++)
+	{
+		const float dx = bloc.X[i] - centre.getX();
+		const float dy = bloc.Y[i] - centre.getY();
+		const float dz = bloc.Z[i] - centre.getZ();
+		// (r^2)^(-(puissance + 1) / 2) = 1 / r^(puissance + 1)
+		const float facteur = k * std::pow(dx * dx + dy * dy + dz * dz + eps2, exposant);
+		FX[i] += facteur * dx;
+		FY[i] += facteur * dy;
+		FZ[i] += facteur * dz;
+	}
+}
+
+DoubleVector3 MathLib::force_et_moment(const Matrix& W, const FVector3& G, const FVector3& v, const FVector3& omega, float m,
+	const std::vector<const ForceField*>& champs)
+{
+	return reduire(W, nullptr, G, v, omega, m, champs);
+}
+
+DoubleVector3 MathLib::force_et_moment(const Matrix& reference, const FMatrix3& R, const FVector3& G, const FVector3& v,
+	const FVector3& omega, float m, const std::vector<const ForceField*>& champs)
+{
+	return reduire(reference, &R, G, v, omega, m, champs);
+}
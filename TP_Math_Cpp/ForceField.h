@@ -0,0 +1,136 @@
+#pragma once
+
+#include "FMatrix3.h"
+#include "FVector3.h"
+#include "Matrix.h"
+#include "StructHeader.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Block of points of a solid given to a force field: positions and speeds as coordinate arrays
+ * Every point carries the same share of the mass of the solid
+ */
+struct PointsBloc
+{
+	const float* X;
+	const float* Y;
+	const float* Z;
+	const float* VX;
+	const float* VY;
+	const float* VZ;
+	float masse;     // Mass of one point
+	std::size_t n;   // Number of points, at most ForceField::BLOC
+};
+
+/**
+ * Force applied on every point of a solid (distributed load), as opposed to the point forces of MathLib::mouvement
+ * A field works on a block of points at once, so its loop runs over contiguous floats the compiler can vectorize
+ */
+class ForceField
+{
+public:
+	// Number of points of a block, also the grain of the parallel reduction
+	static constexpr std::size_t BLOC = 1024;
+
+	virtual ~ForceField() = default;
+
+	// Add the force on each point of the block to FX, FY and FZ
+	virtual void evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const = 0;
+};
+
+/**
+ * Uniform gravity: m g on every point
+ */
+class GravityField : public ForceField
+{
+public:
+	explicit GravityField(const FVector3& g) : g(g) {}
+
+	void evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const override;
+
+private:
+	FVector3 g;
+};
+
+/**
+ * Linear drag: -k (v - vent) on every point, k being per point
+ */
+class DragField : public ForceField
+{
+public:
+	explicit DragField(float k, const FVector3& vent = FVector3::Zero()) : k(k), vent(vent) {}
+
+	void evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const override;
+
+private:
+	float k;
+	FVector3 vent;  // Speed of the surrounding fluid
+};
+
+/**
+ * Central field: m intensite (p - C) / r^(puissance + 1), intensite < 0 attracts towards C
+ * puissance = 2 gives a gravity well, puissance = -1 a spring towards C
+ * The distance is softened, r^2 = |p - C|^2 + adoucissement^2, so points close to C stay finite
+ */
+class RadialField : public ForceField
+{
+public:
+	RadialField(const FVector3& centre, float intensite, float puissance = 2.f, float adoucissement = 1e-3f)
+		: centre(centre), intensite(intensite), puissance(puissance), adoucissement(adoucissement) {}
+
+	void evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const override;
+
+private:
+	FVector3 centre;
+	float intensite;
+	float puissance;
+	float adoucissement;
+};
+
+/**
+ * Field given by a callable taking (const FVector3& p, const FVector3& v, float m) and returning the force on that point
+ * MathLib::force_et_moment evaluates the blocks on the threads of the pool, so the callable is run concurrently
+ * and must be thread-safe: no unsynchronized state shared between calls
+ */
+template<class Function>
+class LambdaField : public ForceField
+{
+public:
+	explicit LambdaField(Function f) : f(std::move(f)) {}
+
+	void evaluer(const PointsBloc& bloc, float* FX, float* FY, float* FZ) const override
+	{
+		for (std::size_t i = 0; i < bloc.n; i++)
+		{
+			const FVector3 F = f(FVector3(bloc.X[i], bloc.Y[i], bloc.Z[i]), FVector3(bloc.VX[i], bloc.VY[i], bloc.VZ[i]), bloc.masse);
+			FX[i] += F.getX();
+			FY[i] += F.getY();
+			FZ[i] += F.getZ();
+		}
+	}
+
+private:
+	Function f;
+};
+
+namespace MathLib
+{
+	/**
+	 * Net force and torque about G of force fields on the points of a solid
+	 * @param W : Solid matrix, points in the world frame
+	 * @param G : Center of gravity
+	 * @param v : Linear speed
+	 * @param omega : Angular speed, a point moves at v + omega x (p - G)
+	 * @param m : Mass, shared evenly by the points
+	 * @param champs : Fields applied
+	 * @return : Total force and torque about G
+	 */
+	DoubleVector3 force_et_moment(const Matrix& W, const FVector3& G, const FVector3& v, const FVector3& omega, float m,
+		const std::vector<const ForceField*>& champs);
+	// Same with the points given in the body frame (centered on G, unrotated), placed by p = R * reference + G on the fly
+	DoubleVector3 force_et_moment(const Matrix& reference, const FMatrix3& R, const FVector3& G, const FVector3& v,
+		const FVector3& omega, float m, const std::vector<const ForceField*>& champs);
+}
@@ -0,0 +1,161 @@
+#include "FrameSink.h"
+
+#include "JsonConverter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+FileSink::FileSink(const std::string& chemin)
+	: file(chemin), avecPoints(false), reference(3, 0), points(3, 0)
+{
+	if (!file)
+		throw std::runtime_error("Cannot open " + chemin);
+}
+
+FileSink::FileSink(const std::string& chemin, const Matrix& W, const FVector3& G, const FVector3& teta)
+	: file(chemin), avecPoints(true), reference(Trajectory::repereCorps(W, G, teta)), points(3, W.getCols())
+{
+	if (!file)
+		throw std::runtime_error("Cannot open " + chemin);
+}
+
+void FileSink::recevoir(const Pose& pose)
+{
+	if (avecPoints)
+		Trajectory::placer(reference, pose, points);
+	file << encoder(pose, avecPoints ? &points : nullptr) << '\n';
+}
+
+std::string FileSink::encoder(const Pose& pose, const Matrix* points)
+{
+	json j = JsonConverter::PoseToJson(pose);
+	if (points)
+		j["Matrice"] = JsonConverter::MatrixToJson(*points)["Matrice"];
+	return j.dump();
+}
+
+void FileSink::terminer()
+{
+	file.flush();
+}
+
+RingBufferSink::RingBufferSink(std::size_t capacite)
+	: capacite(capacite)
+{
+	if (capacite == 0)
+		throw std::invalid_argument("Ring buffer needs a capacity of at least one frame");
+	buffer.reserve(capacite);
+}
+
+void RingBufferSink::recevoir(const Pose& pose)
+{
+	// Fill the buffer, then overwrite the oldest frame
+	if (buffer.size() < capacite)
+		buffer.push_back(pose);
+	else
+	{
+		buffer[debut] = pose;
+		debut = (debut + 1) % buffer.size();
+	}
+	count = buffer.size();
+	++total;
+}
+
+const Pose& RingBufferSink::operator[](std::size_t i) const
+{
+	if (i >= count)
+		throw std::out_of_range("Frame index out of range.");
+	return buffer[(debut + i) % buffer.size()];
+}
+
+void StatisticsSink::recevoir(const Pose& pose)
+{
+	const auto norme = [](const FVector3& u)
+	{
+		return std::sqrt(static_cast<double>(u.getX()) * u.getX() + static_cast<double>(u.getY()) * u.getY()
+			+ static_cast<double>(u.getZ()) * u.getZ());
+	};
+
+	if (count == 0)
+		GMin = GMax = pose.G;
+	GMin = { std::min(GMin.getX(), pose.G.getX()), std::min(GMin.getY(), pose.G.getY()), std::min(GMin.getZ(), pose.G.getZ()) };
+	GMax = { std::max(GMax.getX(), pose.G.getX()), std::max(GMax.getY(), pose.G.getY()), std::max(GMax.getZ(), pose.G.getZ()) };
+
+	++count;
+	vitesse.ajouter(norme(pose.v));
+	vitesseAngulaire.ajouter(norme(pose.tetap));
+}
+
+void MultiSink::recevoir(const Pose& pose)
+{
+	for (FrameSink* sink : sinks)
+		sink->recevoir(pose);
+}
+
+void MultiSink::terminer()
+{
+	for (FrameSink* sink : sinks)
+		sink->terminer();
+}
+
+/**
+ * Move a solid by n steps of h and send its pose to a sink every pas steps
+ * The initial pose is sent first, so the sink receives 1 + n / pas frames
+ * @param corps : Solid, moved in place
+ * @param F : List of forces
+ * @param A : List of application points
+ * @param h : Internal time step
+ * @param n : Number of steps
+ * @param pas : Number of steps between two frames
+ * @param sink : Receiver of the frames
+ */
+void MathLib::simuler(RigidBody& corps, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A,
+	float h, int n, int pas, FrameSink& sink)
+{
+	if (!(h > 0))
+		throw std::invalid_argument("Time step must be positive");
+	if (pas < 1)
+		throw std::invalid_argument("Output stride must be at least 1");
+	sink.recevoir(Pose::fromState(0.f, corps.getMotionState()));
+	for (int i = 1; i <= n; i++)
+	{
+		corps.step(F, A, h);
+		if (i % pas == 0)
+			sink.recevoir(Pose::fromState(static_cast<float>(i) * h, corps.getMotionState()));
+	}
+	sink.terminer();
+}
+
+/**
+ * Move a solid by steps of at most h and send its pose to a sink at the requested times
+ * The step before an output time is shortened to land on it
+ * @param corps : Solid, moved in place
+ * @param F : List of forces
+ * @param A : List of application points
+ * @param h : Internal time step
+ * @param temps : Output times, increasing and positive
+ * @param sink : Receiver of the frames
+ */
+void MathLib::simuler(RigidBody& corps, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A,
+	float h, const std::vector<float>& temps, FrameSink& sink)
+{
+	if (!(h > 0))
+		throw std::invalid_argument("Time step must be positive");
+	if (!std::is_sorted(temps.begin(), temps.end()) || (!temps.empty() && temps.front() < 0))
+		throw std::invalid_argument("Output times must be increasing and positive");
+	double t = 0;
+	for (const float cible : temps)
+	{
+		while (t < cible)
+		{
+			// A remainder below a thousandth of a step is merged into the previous one
+			const double reste = cible - t;
+			const double pas = reste <= 1.001 * h ? reste : h;
+			corps.step(F, A, static_cast<float>(pas));
+			t = reste <= 1.001 * h ? static_cast<double>(cible) : t + pas;
+		}
+		sink.recevoir(Pose::fromState(cible, corps.getMotionState()));
+	}
+	sink.terminer();
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Matrix.h"
+#include "RigidBody.h"
+#include "Trajectory.h"
+#include "Welford.h"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Receiver of the frames of a simulation, fed one pose at a time while the simulation runs
+ */
+class FrameSink
+{
+public:
+	virtual ~FrameSink() = default;
+
+	virtual void recevoir(const Pose& pose) = 0;
+	// Called once the simulation is over
+	virtual void terminer() {}
+};
+
+/**
+ * Append the frames to a Trajectory, the only sink whose memory grows with the simulation
+ */
+class TrajectorySink : public FrameSink
+{
+public:
+	explicit TrajectorySink(Trajectory& trajectoire) : trajectoire(trajectoire) {}
+
+	void recevoir(const Pose& pose) override { trajectoire.ajouter(pose); }
+
+private:
+	Trajectory& trajectoire;
+};
+
+/**
+ * Write each frame as one JSON object per line, with the points of the solid when a solid is given
+ */
+class FileSink : public FrameSink
+{
+public:
+	explicit FileSink(const std::string& chemin);
+	// W is the solid at the start of the simulation, with its center of gravity G and its angles teta
+	FileSink(const std::string& chemin, const Matrix& W, const FVector3& G, const FVector3& teta);
+
+	void recevoir(const Pose& pose) override;
+	void terminer() override;
+
+	// One line of the file, points is the solid placed at the pose or nullptr
+	static std::string encoder(const Pose& pose, const Matrix* points);
+
+private:
+	std::ofstream file;
+	bool avecPoints;
+	Matrix reference;  // Solid in the body frame
+	Matrix points;     // Scratch buffer of one frame
+};
+
+/**
+ * Keep the last frames in a fixed buffer
+ */
+class RingBufferSink : public FrameSink
+{
+public:
+	explicit RingBufferSink(std::size_t capacite);
+
+	void recevoir(const Pose& pose) override;
+
+	// Number of frames kept, at most the capacity
+	std::size_t size() const { return count; }
+	// i-th frame kept, from the oldest
+	const Pose& operator[](std::size_t i) const;
+	// Number of frames received
+	std::size_t recus() const { return total; }
+
+private:
+	std::vector<Pose> buffer;
+	std::size_t capacite;  // Frames kept, reserve may give the buffer more room
+	std::size_t debut = 0;
+	std::size_t count = 0;
+	std::size_t total = 0;
+};
+
+/**
+ * Running statistics of the frames: bounding box of G, mean and deviation of the linear and angular speeds
+ * Means and variances are updated with Welford's algorithm
+ */
+class StatisticsSink : public FrameSink
+{
+public:
+	void recevoir(const Pose& pose) override;
+
+	std::size_t size() const { return count; }
+	const FVector3& getGMin() const { return GMin; }
+	const FVector3& getGMax() const { return GMax; }
+	double vitesseMoyenne() const { return vitesse.moyenne; }
+	double vitesseEcartType() const { return vitesse.ecartType(); }
+	double vitesseMax() const { return vitesse.max; }
+	double vitesseAngulaireMoyenne() const { return vitesseAngulaire.moyenne; }
+	double vitesseAngulaireEcartType() const { return vitesseAngulaire.ecartType(); }
+
+private:
+	std::size_t count = 0;
+	FVector3 GMin, GMax;
+	Welford vitesse;
+	Welford vitesseAngulaire;
+};
+
+/**
+ * Forward every frame to several sinks
+ */
+class MultiSink : public FrameSink
+{
+public:
+	MultiSink(std::initializer_list<FrameSink*> sinks) : sinks(sinks) {}
+
+	void recevoir(const Pose& pose) override;
+	void terminer() override;
+
+private:
+	std::vector<FrameSink*> sinks;
+};
+
+namespace MathLib
+{
+	void simuler(RigidBody& corps, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A,
+		float h, int n, int pas, FrameSink& sink);
+	void simuler(RigidBody& corps, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A,
+		float h, const std::vector<float>& temps, FrameSink& sink);
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "FMatrix3.h"
+#include "FQuaternion.h"
+#include "FVector3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Kinematic state of a solid: linear position and speed, angles and angular speed
+ * tetap is the angular speed in the world frame, the one the torque accelerates through the world-frame inertia,
+ * and not the derivative of the angles: every scheme turns the orientation by the rotation vector tetap h
+ */
+struct MotionState
+{
+	FVector3 G;      // Center of gravity
+	FVector3 v;      // Linear speed
+	FVector3 teta;   // Angles around X, Y and Z of the rotation Rz * Ry * Rx
+	FVector3 tetap;  // Angular speed in the world frame
+};
+
+inline MotionState operator+(const MotionState& a, const MotionState& b)
+{
+	return { a.G + b.G, a.v + b.v, a.teta + b.teta, a.tetap + b.tetap };
+}
+
+inline MotionState operator*(const MotionState& a, float value)
+{
+	return { a.G * value, a.v * value, a.teta * value, a.tetap * value };
+}
+
+/**
+ * Settings of the adaptive integration
+ */
+struct AdaptiveOptions
+{
+	float tolAbs = 1e-4f;  // Absolute tolerance on every component of the state
+	float tolRel = 1e-4f;  // Relative tolerance on every component of the state
+	float hMin = 1e-6f;    // Smallest step allowed, below it the integration fails
+	float hMax = 0.1f;     // Largest step allowed
+	float h0 = 1e-2f;      // First step tried
+};
+
+/**
+ * Time integration schemes, used as the template parameter of RigidBody::step
+ * Each scheme advances a MotionState by h given a callable returning the accelerations of a state
+ * as a DoubleVector3 { linear acceleration, angular acceleration }
+ */
+namespace Integrators
+{
+	/**
+	 * Orientation turned by a rotation vector of the world frame, R(next) = exp(r) * R(teta)
+	 * @param teta : Angles
+	 * @param r : Rotation vector, angular speed times time
+	 * @return : Angles of the new orientation, in [-pi, pi]
+	 */
+	inline FVector3 tourner(const FVector3& teta, const FVector3& r)
+	{
+		return (FQuaternion::exp(r) * FQuaternion::fromEuler(teta)).normalized().toEuler();
+	}
+
+	/**
+	 * State advanced along a derivative (v, a, tetap, alpha) for dt
+	 * The teta member of the derivative is an angular speed: it turns the orientation instead of being added to the angles
+	 */
+	inline MotionState avance(const MotionState& s, const MotionState& d, float dt)
+	{
+		return { s.G + d.G * dt, s.v + d.v * dt, tourner(s.teta, d.teta * dt), s.tetap + d.tetap * dt };
+	}
+
+	// First order, positions use the speeds at the beginning of the step
+	struct ExplicitEuler
+	{
+		template<class Acceleration>
+		static MotionState step(const MotionState& s, Acceleration&& acceleration, float h)
+		{
+			const DoubleVector3 a = acceleration(s);
+			return { s.G + s.v * h, s.v + a.v1 * h, tourner(s.teta, s.tetap * h), s.tetap + a.v2 * h };
+		}
+	};
+
+	// First order symplectic, positions use the updated speeds (the historic MathLib::translation / rotation update)
+	struct SemiImplicitEuler
+	{
+		template<class Acceleration>
+		static MotionState step(const MotionState& s, Acceleration&& acceleration, float h)
+		{
+			const DoubleVector3 a = acceleration(s);
+			const FVector3 v = a.v1 * h + s.v;
+			const FVector3 tetap = s.tetap + a.v2 * h;
+			return { v * h + s.G, v, tourner(s.teta, tetap * h), tetap };
+		}
+	};
+
+	// Second order, two evaluations per step
+	struct VelocityVerlet
+	{
+		template<class Acceleration>
+		static MotionState step(const MotionState& s, Acceleration&& acceleration, float h)
+		{
+			const DoubleVector3 a0 = acceleration(s);
+			MotionState next;
+			next.v = s.v + a0.v1 * (0.5f * h);
+			next.tetap = s.tetap + a0.v2 * (0.5f * h);
+			next.G = s.G + next.v * h;
+			next.teta = tourner(s.teta, next.tetap * h);
+			// Speeds at half step stand in for the final ones if the accelerations depend on them
+			const DoubleVector3 a1 = acceleration(next);
+			next.v = next.v + a1.v1 * (0.5f * h);
+			next.tetap = next.tetap + a1.v2 * (0.5f * h);
+			return next;
+		}
+	};
+
+	// Classic fourth order Runge-Kutta, four evaluations per step
+	struct RK4
+	{
+		template<class Acceleration>
+		static MotionState step(const MotionState& s, Acceleration&& acceleration, float h)
+		{
+			// Derivative of a state: (v, a, tetap, alpha)
+			const auto derivee = [&acceleration](const MotionState& e) -> MotionState
+			{
+				const DoubleVector3 a = acceleration(e);
+				return { e.v, a.v1, e.tetap, a.v2 };
+			};
+
+			const MotionState k1 = derivee(s);
+			const MotionState k2 = derivee(avance(s, k1, 0.5f * h));
+			const MotionState k3 = derivee(avance(s, k2, 0.5f * h));
+			const MotionState k4 = derivee(avance(s, k3, h));
+			// The orientation turns once by the weighted mean of the angular speeds
+			return avance(s, k1 + k2 * 2.f + k3 * 2.f + k4, h / 6.f);
+		}
+	};
+
+	/**
+	 * Rotation group integrator, for large steps on spinning solids
+	 * The angular speed follows Euler's equations in the body frame, I dw/dt + w x (I w) = torque, with the implicit
+	 * midpoint rule (solved by Newton), which keeps the energy and the angular momentum of a free solid.
+	 * The orientation is then rotated by the exponential map of the mean speed, as tourner does for the other schemes.
+	 * The linear part is the semi-implicit Euler one
+	 * The step also takes the inertia in the body frame (orientation teta = 0), RigidBody provides it
+	 */
+	struct ExponentialMap
+	{
+		// Newton iterations of the implicit midpoint rule, converges in 2 or 3 for h * |w| < 1
+		static constexpr int ITERATIONS = 4;
+
+		template<class Acceleration>
+		static MotionState step(const MotionState& s, Acceleration&& acceleration, float h, const FMatrix3& I_corps)
+		{
+			const DoubleVector3 a = acceleration(s);
+			const FVector3 v = a.v1 * h + s.v;
+			const FQuaternion q = FQuaternion::fromEuler(s.teta);
+
+			// Speed in the body frame, with the angular acceleration of the torque already applied
+			const FVector3 w0 = q.conjugate() * s.tetap;
+			const FVector3 cible = I_corps * (w0 + q.conjugate() * a.v2 * h);
+			// Solve I w1 + h wm x (I wm) = cible with wm = (w0 + w1) / 2
+			FVector3 w1 = w0;
+			for (int i = 0; i < ITERATIONS; ++i)
+			{
+				const FVector3 wm = (w0 + w1) * 0.5f;
+				const FVector3 Iwm = I_corps * wm;
+				const FVector3 f = I_corps * w1 + FVector3::prodVect(wm, Iwm) * h - cible;
+				const FMatrix3 J = I_corps + (FMatrix3::skew(wm) * I_corps + FMatrix3::skew(Iwm) * -1.f) * (0.5f * h);
+				w1 = w1 - FMatrix3::inverse(J) * f;
+			}
+
+			// Body frame speeds compose on the right
+			const FQuaternion next = (q * FQuaternion::exp((w0 + w1) * (0.5f * h))).normalized();
+			return { v * h + s.G, v, next.toEuler(), next * w1 };
+		}
+	};
+
+	// Schemes whose step also takes the inertia in the body frame
+	template<class Integrator> struct UtiliseInertieCorps : std::false_type {};
+	template<> struct UtiliseInertieCorps<ExponentialMap> : std::true_type {};
+
+	/**
+	 * Embedded Bogacki-Shampine 3(2) pair: third order solution, second order one for the error estimate
+	 * The last evaluation is the first one of the next step (FSAL), so an accepted step costs three evaluations
+	 */
+	struct BogackiShampine
+	{
+		/**
+		 * @param s : State at the beginning of the step
+		 * @param k1 : Derivative at s, replaced by the derivative at the end of the step
+		 * @param derivee : callable returning the derivative (v, a, tetap, alpha) of a state
+		 * @param h : Time step
+		 * @param erreur : Output, difference between the third and the second order solutions
+		 * @return : Third order state at the end of the step
+		 */
+		template<class Derivee>
+		static MotionState step(const MotionState& s, MotionState& k1, Derivee&& derivee, float h, MotionState& erreur)
+		{
+			const MotionState k2 = derivee(avance(s, k1, 0.5f * h));
+			const MotionState k3 = derivee(avance(s, k2, 0.75f * h));
+			const MotionState next = avance(s, k1 * (2.f / 9.f) + k2 * (1.f / 3.f) + k3 * (4.f / 9.f), h);
+			const MotionState k4 = derivee(next);
+			erreur = (k1 * (-5.f / 72.f) + k2 * (1.f / 12.f) + k3 * (1.f / 9.f) + k4 * (-1.f / 8.f)) * h;
+			k1 = k4;
+			return next;
+		}
+	};
+
+	/**
+	 * Integrate with an adaptive step and report the state at the requested times
+	 * Steps are shortened to land exactly on the output times, so no interpolation is needed
+	 * @param s : Initial state at t0
+	 * @param acceleration : callable returning the accelerations of a state
+	 * @param t0 : Initial time
+	 * @param temps : Output times, increasing and not before t0
+	 * @param options : Tolerances and step limits
+	 * @param sortie : callable taking (float t, const MotionState&) for each output time
+	 * @param acceptes : Output, number of accepted steps
+	 * @param rejetes : Output, number of rejected steps
+	 */
+	template<class Acceleration, class Sortie>
+	void integrerAdaptatif(MotionState s, Acceleration&& acceleration, float t0, const std::vector<float>& temps,
+		const AdaptiveOptions& options, Sortie&& sortie, int& acceptes, int& rejetes)
+	{
+		if (!std::is_sorted(temps.begin(), temps.end()) || (!temps.empty() && temps.front() < t0))
+			throw std::invalid_argument("Output times must be increasing and not before t0");
+
+		const auto derivee = [&acceleration](const MotionState& e) -> MotionState
+		{
+			const DoubleVector3 a = acceleration(e);
+			return { e.v, a.v1, e.tetap, a.v2 };
+		};
+		// Weighted RMS norm of the error, a step is accepted below 1
+		const auto norme = [&options](const MotionState& e, const MotionState& a, const MotionState& b)
+		{
+			// The four members one by one, they are distinct objects and not an array
+			const FVector3 MotionState::* const membres[4] = { &MotionState::G, &MotionState::v, &MotionState::teta, &MotionState::tetap };
+			double somme = 0;
+			for (const auto membre : membres)
+			{
+				const FVector3& E = e.*membre;
+				const FVector3& A = a.*membre;
+				const FVector3& B = b.*membre;
+				const float comp[3][3] = {
+					{ E.getX(), A.getX(), B.getX() },
+					{ E.getY(), A.getY(), B.getY() },
+					{ E.getZ(), A.getZ(), B.getZ() }
+				};
+				for (const auto& c : comp)
+				{
+					const double echelle = options.tolAbs + options.tolRel * std::max(std::abs(c[1]), std::abs(c[2]));
+					somme += (c[0] / echelle) * (c[0] / echelle);
+				}
+			}
+			return std::sqrt(somme / 12.0);
+		};
+
+		acceptes = 0;
+		rejetes = 0;
+		float t = t0;
+		float h = std::min(options.h0, options.hMax);
+		MotionState k1 = derivee(s);
+		for (const float cible : temps)
+		{
+			while (t < cible)
+			{
+				// Do not overshoot the next output time
+				const bool dernier = t + h >= cible;
+				const float pas = dernier ? cible - t : h;
+				MotionState k = k1;
+				MotionState erreur;
+				const MotionState next = BogackiShampine::step(s, k, derivee, pas, erreur);
+				const double err = norme(erreur, s, next);
+
+				if (err <= 1.0 || pas <= options.hMin)
+				{
+					if (err > 1.0)
+						throw std::runtime_error("Adaptive step fell below hMin, tolerances cannot be met");
+					s = next;
+					k1 = k;
+					t = dernier ? cible : t + pas;
+					++acceptes;
+				}
+				else
+					++rejetes;
+
+				// Standard controller for a third order error, growth limited to x5 and shrink to x0.2
+				const double facteur = err > 0 ? 0.9 * std::pow(err, -1.0 / 3.0) : 5.0;
+				const float propose = static_cast<float>(pas * std::min(5.0, std::max(0.2, facteur)));
+				// A step shortened to hit an output time does not shrink the next one
+				h = std::min(options.hMax, std::max(options.hMin, dernier && err <= 1.0 ? std::max(h, propose) : propose));
+			}
+			sortie(cible, s);
+		}
+	}
+}
@@ -1,7 +1,12 @@
 #include "JsonConverter.h"
 
 #include "FVector3.h"
+#include "MathLib.h"
 #include "Matrix.h"
+#include "Shape.h"
+#include "Trajectory.h"
+
+#include <limits>
 
 json JsonConverter::FVector3ToJson(const FVector3& v)
 {
@@ -31,4 +36,60 @@ json JsonConverter::DoubleVector3ToJson(const DoubleVector3& v)
 	j["v1"] = FVector3ToJson(v.v1);
 	j["v2"] = FVector3ToJson(v.v2);
 	return j;
-}
\ No newline at end of file
+}
+
+json JsonConverter::PoseToJson(const Pose& pose)
+{
+	const FVector3 teta = pose.teta();
+	json j;
+	j["t"] = pose.t;
+	j["G"] = { pose.G.getX(), pose.G.getY(), pose.G.getZ() };
+	j["teta"] = { teta.getX(), teta.getY(), teta.getZ() };
+	j["v"] = { pose.v.getX(), pose.v.getY(), pose.v.getZ() };
+	j["tetap"] = { pose.tetap.getX(), pose.tetap.getY(), pose.tetap.getZ() };
+	return j;
+}
+/**
+ * Write a shape in the same format as MatrixToJson without materializing it
+ * Each row is streamed chunk by chunk, so memory use does not depend on the size of the shape
+ * @param os : Output stream
+ * @param shape : Shape to write
+ */
+void JsonConverter::WriteShape(std::ostream& os, const Shape& shape)
+{
+	WriteShape(os, shape, FVector3::Zero(), FVector3::Zero());
+}
+
+/**
+ * Write a shape rotated by teta around G, in the same format as MatrixToJson
+ * @param os : Output stream
+ * @param shape : Shape to write
+ * @param G : Center of the rotation
+ * @param teta : Angles around X, Y and Z
+ */
+void JsonConverter::WriteShape(std::ostream& os, const Shape& shape, const FVector3& G, const FVector3& teta)
+{
+	const FMatrix3 R = MathLib::matrice_rotation(teta);
+	const auto precision = os.precision(std::numeric_limits<float>::max_digits10);
+	os << "{\"Matrice\":[";
+	for (int row = 0; row < 3; ++row)
+	{
+		os << (row == 0 ? "[" : ",[");
+		bool first = true;
+		shape.forEachChunk([&](const float* X, const float* Y, const float* Z, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const float x = X[i] - G.getX();
+				const float y = Y[i] - G.getY();
+				const float z = Z[i] - G.getZ();
+				const float value = R[row][0] * x + R[row][1] * y + R[row][2] * z + (row == 0 ? G.getX() : row == 1 ? G.getY() : G.getZ());
+				os << (first ? "" : ",") << value;
+				first = false;
+			}
+		});
+		os << "]";
+	}
+	os << "]}";
+	os.precision(precision);
+}
@@ -1,15 +1,22 @@
 #pragma once
 #include "json.hpp"
 
+#include <ostream>
+
 using json = nlohmann::json;
 class FVector3;
 class Matrix;
+class Shape;
 struct DoubleVector3;
+struct Pose;
 
 namespace JsonConverter
 {
 	json FVector3ToJson(const FVector3& v);
 	json MatrixToJson(const Matrix& m);
 	json DoubleVector3ToJson(const DoubleVector3& v);
+	json PoseToJson(const Pose& pose);
+	void WriteShape(std::ostream& os, const Shape& shape);
+	void WriteShape(std::ostream& os, const Shape& shape, const FVector3& G, const FVector3& teta);
 };
 
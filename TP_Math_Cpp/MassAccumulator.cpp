@@ -0,0 +1,97 @@
+#include "MassAccumulator.h"
+
+#include "MathLib.h"
+
+#include <stdexcept>
+
+void MassAccumulator::add(const FVector3& P, float m)
+{
+	sommes += Moments::bloc(&P, 1) * m;
+}
+
+void MassAccumulator::remove(const FVector3& P, float m)
+{
+	sommes -= Moments::bloc(&P, 1) * m;
+}
+
+void MassAccumulator::add(const std::vector<FVector3>& L, float m)
+{
+	if (L.empty())
+		return;
+	sommes += MathLib::moments(L) * (m / static_cast<double>(L.size()));
+}
+
+void MassAccumulator::remove(const std::vector<FVector3>& L, float m)
+{
+	if (L.empty())
+		return;
+	sommes -= MathLib::moments(L) * (m / static_cast<double>(L.size()));
+}
+
+void MassAccumulator::add(const Shape& S, float m)
+{
+	const Moments M = MathLib::moments(S);
+	if (M.n > 0)
+		sommes += M * (m / M.n);
+}
+
+void MassAccumulator::merge(const MassAccumulator& other)
+{
+	sommes += other.sommes;
+}
+
+void MassAccumulator::remove(const MassAccumulator& other)
+{
+	sommes -= other.sommes;
+}
+
+float MassAccumulator::masse() const
+{
+	return static_cast<float>(sommes.n);
+}
+
+FVector3 MassAccumulator::centre() const
+{
+	if (sommes.n <= 0)
+		throw std::runtime_error("MassAccumulator is empty, cannot compute the center of inertia.");
+	return sommes.centre();
+}
+
+/**
+ * Inertia matrix about the center of inertia
+ * The central second moments are computed in double, before the cancellation would hit float precision
+ * @return : The inertia matrix at G
+ */
+Matrix MassAccumulator::inertieCentre() const
+{
+	if (sommes.n <= 0)
+		throw std::runtime_error("MassAccumulator is empty, cannot compute the inertia matrix.");
+	const double m = sommes.n;
+	const double cxx = sommes.sxx - sommes.sx * sommes.sx / m;
+	const double cyy = sommes.syy - sommes.sy * sommes.sy / m;
+	const double czz = sommes.szz - sommes.sz * sommes.sz / m;
+	const double cyz = sommes.syz - sommes.sy * sommes.sz / m;
+	const double cxz = sommes.sxz - sommes.sx * sommes.sz / m;
+	const double cxy = sommes.sxy - sommes.sx * sommes.sy / m;
+	const auto A = static_cast<float>(cyy + czz);
+	const auto B = static_cast<float>(cxx + czz);
+	const auto C = static_cast<float>(cxx + cyy);
+	const auto D = static_cast<float>(cyz);
+	const auto E = static_cast<float>(cxz);
+	const auto F = static_cast<float>(cxy);
+	return {
+		{  A, -F, -E },
+		{ -F,  B, -D },
+		{ -E, -D,  C }
+	};
+}
+
+/**
+ * Inertia matrix about any point, moved from the center of inertia with deplace_matrix
+ * @param A : Point
+ * @return : The inertia matrix at A
+ */
+Matrix MassAccumulator::inertie(const FVector3& A) const
+{
+	return MathLib::deplace_matrix(inertieCentre(), masse(), centre(), A);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "FVector3.h"
+#include "Matrix.h"
+#include "Moments.h"
+
+#include <vector>
+
+class Shape;
+
+/**
+ * Running mass properties of a body
+ * Keeps the mass weighted first and second moments, so points and sub-bodies can be added, removed or merged
+ * without going over the whole body again
+ */
+class MassAccumulator
+{
+public:
+	MassAccumulator() = default;
+
+	// Add or remove a point of mass m
+	void add(const FVector3& P, float m);
+	void remove(const FVector3& P, float m);
+	// Add or remove a list of points sharing a total mass m, like MathLib::matrice_inert
+	void add(const std::vector<FVector3>& L, float m);
+	void remove(const std::vector<FVector3>& L, float m);
+	// Add a procedural shape with a total mass m
+	void add(const Shape& S, float m);
+	// Add or remove a sub-body, or merge the partial accumulator of another thread
+	void merge(const MassAccumulator& other);
+	void remove(const MassAccumulator& other);
+
+	float masse() const;
+	FVector3 centre() const;
+	// Inertia matrix about the center of inertia
+	Matrix inertieCentre() const;
+	// Inertia matrix about any point A
+	Matrix inertie(const FVector3& A) const;
+
+private:
+	// Mass weighted moments, sommes.n is the total mass
+	Moments sommes;
+};
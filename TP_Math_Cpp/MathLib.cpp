@@ -1,4 +1,11 @@
 #include "MathLib.h"
+#include "FrameSink.h"
+#include "Moments.h"
+#include "Parallel.h"
+#include "RigidBody.h"
+#include "Shape.h"
+#include "Trajectory.h"
+#include "TransformPoints.h"
 
 #include <algorithm>
 #include <iostream>
@@ -14,73 +21,6 @@ void MathLib::printMatrix(const Matrix& m, const char* text)
 	std::cout << text << '\n' << m.ToString();
 }
 
-// Solve equation f + f' * h
-float MathLib::solve1(float f, float fp, float h)
-{
-	return f + fp * h;
-}
-
-double MathLib::truncate(double value, int precision)
-{
-	double factor = std::pow(10.0, precision);
-	return std::floor(value * factor) / factor;
-}
-
-double MathLib::roundToPrecision(double value, int precision)
-{
-	double factor = std::pow(10.0f, precision);
-	return std::round(value * factor) / factor;
-}
-
-// Factorial function
-unsigned long long MathLib::factoriel(unsigned int n)
-{
-	unsigned long long result = 1;
-	for (unsigned int i = 2; i <= n; ++i)
-		result *= i;
-	return result;
-}
-
-/**
- * Cosinus function
- * @param x : number
- * @param n : iterations
- * @return : cosinus of x
- */
-double MathLib::cosinus(double x, int n)
-{
-	double cos_x = 1.0; // First term of the Taylor series
-	double term = 1.0;
-	int sign = -1;  
-	for (int i = 1; i < n; ++i)
-	{
-		term *= (x * x) / ((2 * i - 1) * (2 * i));
-		cos_x += sign * term;
-		sign = -sign;
-	}
-	return cos_x;
-}
-
-/**
- * Sinus function
- * @param x : number
- * @param n : iterations
- * @return : sinus of x
- */
-double MathLib::sinus(double x, int n)
-{
-	double sin_x = x; // First term of the Taylor series
-	double term = x;  
-	int sign = -1;  
-	for (int i = 1; i < n; ++i)
-	{
-		term *= (x * x) / ((2 * i) * (2 * i + 1));
-		sin_x += sign * term;
-		sign = -sign;
-	}
-	return sin_x;
-}
-
 /**
  * Translate an object with a mass, a time step, a sum of forces, an inertia center and a speed
 * @param m : mass
@@ -93,8 +33,8 @@ double MathLib::sinus(double x, int n)
 DoubleVector3 MathLib::translation(float m, float h, const FVector3& F, const FVector3& G, const FVector3& v)
 {
 	FVector3 accel = F / m;
-	FVector3 newV = accel * h + v;
-	FVector3 newG = newV * h + G;
+	FVector3 newV = solve1(v, accel, h);
+	FVector3 newG = solve1(G, newV, h);
 	return { newG, newV };
 }
 
@@ -110,23 +50,101 @@ DoubleVector3 MathLib::translation(float m, float h, const FVector3& F, const FV
 * @return : New angle and angular speed
 */
 DoubleVector3 MathLib::rotation(float h, const std::vector<FVector3>& F, const std::vector<FVector3>& A, const FVector3& G, const Matrix& I, const FVector3& teta, const FVector3& tetap)
+{
+	const FVector3 torque = moment_total(F, A, G);
+	const FMatrix3 I_inv = FMatrix3::fromMatrix(Matrix::inverse(I));
+	return rotation(h, torque, I_inv, teta, tetap);
+}
+
+/**
+ * Rotate an object with a time step, a torque, an inverse inertia matrix, an angle and an angular speed
+ * @param h : time step
+ * @param torque : sum of the moments about the inertia center
+ * @param I_inv : inverse of the inertia matrix
+ * @param teta : angle
+ * @param tetap : angular speed
+ * @return : New angle and angular speed
+ */
+DoubleVector3 MathLib::rotation(float h, const FVector3& torque, const FMatrix3& I_inv, const FVector3& teta, const FVector3& tetap)
+{
+	// Calculate angular acceleration
+	FVector3 angularAcc = I_inv * torque;
+
+	// Update angular speed and angle
+	FVector3 newAngularVel = solve1(tetap, angularAcc, h);
+	FVector3 newAngles = solve1(teta, newAngularVel, h);
+
+	return { newAngles, newAngularVel };
+}
+
+/**
+ * Sum of the moments about G of a list of forces
+ * @param F : list of forces
+ * @param A : list of application points
+ * @param G : inertia center
+ * @return : Total torque
+ */
+FVector3 MathLib::moment_total(const std::vector<FVector3>& F, const std::vector<FVector3>& A, const FVector3& G)
 {
 	if (F.size() != A.size())
 		throw std::invalid_argument("F and A must have the same size");
-	
+
 	FVector3 torque = FVector3::Zero();
 	for (size_t i = 0; i < F.size(); ++i)
 		torque = torque + FVector3::moment(F[i], A[i], G);
+	return torque;
+}
 
-	// Calculate angular acceleration
-	Matrix I_inv = Matrix::inverse(I);
-	FVector3 angularAcc = I_inv * torque;
+/**
+ * Reduce a list of points to its first and second moments
+ * Fixed blocks are reduced in parallel then summed pairwise in order, so the result does not depend on the number of threads
+ * @param L : List of points
+ * @return : Moments of the points
+ */
+Moments MathLib::moments(const std::vector<FVector3>& L)
+{
+	return parallel_reduce(0, L.size(), Moments::BLOC, Moments(),
+		[&](std::size_t first, std::size_t last) { return Moments::bloc(L.data() + first, last - first); },
+		[](const Moments& a, const Moments& b) { return a + b; });
+}
 
-	// Update angular speed and angle
-	FVector3 newAngularVel = tetap + angularAcc * h;
-	FVector3 newAngles = teta + newAngularVel * h;
+/**
+ * Reduce a procedural shape to its first and second moments without materializing it
+ * Super blocks of PARALLEL_GRAIN points are generated and reduced in parallel, a few per thread at a time
+ * @param S : Shape
+ * @return : Moments of the points
+ */
+Moments MathLib::moments(const Shape& S)
+{
+	const std::size_t n = S.size();
+	const std::size_t superBlocs = (n + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+	const std::size_t vague = 4 * static_cast<std::size_t>(nombreThreads());
+	std::vector<Moments> partiels(std::min(vague, superBlocs));
 
-	return { newAngles, newAngularVel };
+	MomentsPairwise somme;
+	for (std::size_t debutVague = 0; debutVague < superBlocs; debutVague += vague)
+	{
+		const std::size_t finVague = std::min(debutVague + vague, superBlocs);
+		parallel_for(debutVague, finVague, 1, [&](std::size_t first, std::size_t last)
+		{
+			float buffer[3][Moments::BLOC];
+			for (std::size_t sb = first; sb < last; ++sb)
+			{
+				MomentsPairwise local;
+				const std::size_t fin = std::min(n, (sb + 1) * PARALLEL_GRAIN);
+				for (std::size_t debut = sb * PARALLEL_GRAIN; debut < fin; debut += Moments::BLOC)
+				{
+					const std::size_t count = std::min(Moments::BLOC, fin - debut);
+					S.generate(debut, count, buffer[0], buffer[1], buffer[2]);
+					local.push(Moments::bloc(buffer[0], buffer[1], buffer[2], count));
+				}
+				partiels[sb - debutVague] = local.result();
+			}
+		});
+		for (std::size_t sb = debutVague; sb < finVague; ++sb)
+			somme.push(partiels[sb - debutVague]);
+	}
+	return somme.result();
 }
 
 /**
@@ -136,10 +154,7 @@ DoubleVector3 MathLib::rotation(float h, const std::vector<FVector3>& F, const s
  */
 FVector3 MathLib::centre_inert(const std::vector<FVector3>& L)
 {
-	FVector3 G = FVector3::Zero();
-	for (const auto& i : L)
-		G += i;
-	return G / static_cast<float>(L.size());
+	return moments(L).centre();
 }
 
 /**
@@ -150,28 +165,28 @@ FVector3 MathLib::centre_inert(const std::vector<FVector3>& L)
  */
 Matrix MathLib::matrice_inert(const std::vector<FVector3>& L, float m)
 {
-	float massPerPoint = m / L.size();
-	float A = 0, B = 0, C = 0, D = 0, E = 0, F = 0;
-	for (const auto& i : L)
-	{
-		A += (pow(i.getY(), 2.f) + pow(i.getZ(), 2.f)) * massPerPoint;
-		B += (pow(i.getX(), 2.f) + pow(i.getZ(), 2.f)) * massPerPoint;
-		C += (pow(i.getX(), 2.f) + pow(i.getY(), 2.f)) * massPerPoint;
-		D += i.getY() * i.getZ() * massPerPoint;
-		E += i.getX() * i.getZ() * massPerPoint;
-		F += i.getX() * i.getY() * massPerPoint;
-	}
-	Matrix I(3, 3);
-	I[0][0] = A;
-	I[0][1] = -F;
-	I[0][2] = -E;
-	I[1][0] = -F;
-	I[1][1] = B;
-	I[1][2] = -D;
-	I[2][0] = -E;
-	I[2][1] = -D;
-	I[2][2] = C;
-	return I;
+	return moments(L).inertie(m);
+}
+
+/**
+ * Calculate the center of inertia of a procedural shape, streamed chunk by chunk
+ * @param S : Shape
+ * @return : Center of inertia
+ */
+FVector3 MathLib::centre_inert(const Shape& S)
+{
+	return moments(S).centre();
+}
+
+/**
+ * Calculate the inertia matrix of a procedural shape, streamed chunk by chunk
+ * @param S : Shape
+ * @param m : Total mass
+ * @return : The inertia matrix
+ */
+Matrix MathLib::matrice_inert(const Shape& S, float m)
+{
+	return moments(S).inertie(m);
 }
 
 /**
@@ -186,7 +201,8 @@ Matrix MathLib::deplace_matrix(const Matrix& I, float m, const FVector3& O, cons
 {
 	if (I.getRows() != 3 || I.getCols() != 3)
 		throw std::invalid_argument("Matrix must be 3x3");
-	const FVector3 OA = FVector3::distance(O, A);
+	// Signed offset: the products of inertia depend on the relative signs of its components
+	const FVector3 OA = A - O;
 	Matrix IOA(3, 3);
 	IOA[0][0] = m * (pow(OA.getY(), 2.f) + pow(OA.getZ(), 2.f));
 	IOA[0][1] = -m * OA.getX() * OA.getY();
@@ -202,49 +218,38 @@ Matrix MathLib::deplace_matrix(const Matrix& I, float m, const FVector3& O, cons
 
 Matrix MathLib::rotation_forme(Matrix W, const FVector3& G, const FVector3& teta)
 {
-	// Extract the angles
-	float thetaX = teta.getX();
-	float thetaY = teta.getY();
-	float thetaZ = teta.getZ();
-
-	// Build the rotation matrices
-	float cX = static_cast<float>(cosinus(thetaX));
-	float sX = static_cast<float>(sinus(thetaX));
-	float cY = static_cast<float>(cosinus(thetaY));
-	float sY = static_cast<float>(sinus(thetaY));
-	float cZ = static_cast<float>(cosinus(thetaZ));
-	float sZ = static_cast<float>(sinus(thetaZ));
-	Matrix Rx = {
-		{1, 0, 0},
-		{0, cX, -sX},
-		{0, sX,  cX}
-	};
-	Matrix Ry = {
-		{ cY, 0, sY},
-		{  0, 1,  0},
-		{-sY, 0, cY}
-	};
-	Matrix Rz = {
-		{ cZ, -sZ, 0},
-		{ sZ,  cZ, 0},
-		{  0,   0, 1}
-	};
-
 	// Combined rotation matrix
-	Matrix R = Rz * Ry * Rx;
-
-	// Apply the rotation to each point
-	for (int i = 0; i < W.getCols(); i++)
-	{
-		FVector3 P(W[0][i], W[1][i], W[2][i]);
-		FVector3 P_rotated = R * (P - G) + G;
+	const FMatrix3 R = matrice_rotation(teta);
+	transforme_points(W, R, G);
+	return W;
+}
 
-		W[0][i] = P_rotated.getX();
-		W[1][i] = P_rotated.getY();
-		W[2][i] = P_rotated.getZ();
-	}
+/**
+ * Rotate every point of a solid around G then translate it by t, in place: W = R * (W - G) + G + t
+ * @param W : Solid matrix with 3 rows representing the coordinates X, Y and Z
+ * @param R : Rotation matrix
+ * @param G : Center of the rotation
+ * @param t : Translation applied after the rotation
+ */
+void MathLib::transforme_points(Matrix& W, const FMatrix3& R, const FVector3& G, const FVector3& t)
+{
+	if (W.getCols() > 0 && W.getRows() != 3)
+		throw std::invalid_argument("Solid matrix must have 3 rows");
+	if (W.getCols() > 0)
+		transforme_points(W[0], W[1], W[2], W[0], W[1], W[2], W.getCols(), R, G, G + t);
+}
 
-	return W;
+/**
+ * Rotate then translate every point of a solid into another matrix: W = R * source + T
+ * @param source : Solid matrix with 3 rows representing the coordinates X, Y and Z
+ * @param W : Output, 3xN matrix of the same size
+ * @param R : Rotation matrix
+ * @param T : Translation applied after the rotation
+ */
+void MathLib::transforme_points(const Matrix& source, Matrix& W, const FMatrix3& R, const FVector3& T)
+{
+	if (source.getCols() > 0)
+		transforme_points(source[0], source[1], source[2], W[0], W[1], W[2], source.getCols(), R, FVector3::Zero(), T);
 }
 
 /**
@@ -260,25 +265,23 @@ Matrix MathLib::pave_plein(unsigned int n, float a, float b, float c, const FVec
 {
 	// Calculate the number of iterations for each dimension
 	const int iteration = static_cast<int>(std::cbrt(n));
-	// Calculate the total number of points generated
-	const int totalPoints = static_cast<int>(std::pow(iteration, 3));
-	// Calculate the intervals between points in each dimension
-	const float dx = a / (iteration - 1);
-	const float dy = b / (iteration - 1);
-	const float dz = c / (iteration - 1);
-	Matrix M(3, totalPoints);
-	int index = 0;
-	for (int i = 0; i < iteration && index < n; ++i)
-		for (int j = 0; j < iteration && index < n; ++j)
-			for (int k = 0; k < iteration && index < n; ++k)
-			{
-				// Calculate the coordinates of each points
-				M[0][index] = A0.getX() + i * dx;
-				M[1][index] = A0.getY() + j * dy;
-				M[2][index] = A0.getZ() + k * dz;
-				++index;
-			}
-	return M;
+	return pave_plein(iteration, iteration, iteration, a, b, c, A0);
+}
+
+/**
+ * Create a matrix of points in a geometrical shape with a resolution per axis
+ * @param nx : number of points along the length
+ * @param ny : number of points along the width
+ * @param nz : number of points along the height
+ * @param a : length
+ * @param b : width
+ * @param c : height
+ * @param A0 : first point
+ * @return : Matrix of nx * ny * nz points with 3 rows representing the coordinates X, Y and Z
+ */
+Matrix MathLib::pave_plein(int nx, int ny, int nz, float a, float b, float c, const FVector3& A0)
+{
+	return Box(nx, ny, nz, a, b, c, A0).materialize();
 }
 
 /**
@@ -290,34 +293,7 @@ Matrix MathLib::pave_plein(unsigned int n, float a, float b, float c, const FVec
  */
 Matrix MathLib::cercle_plein(float R, const FVector3& A0, int n)
 {
-	n = std::max(n, 3); // Sécurisation
-	int n_r = n;  // `n_r` est le nombre d'anneaux
-	int n_total = n_r * n + 1;  // Nombre total de points (y compris centre)
-
-	Matrix M(3, n_total);
-	int index = 0;
-
-	// Ajouter le centre
-	M[0][index] = A0.getX();
-	M[1][index] = A0.getY();
-	M[2][index] = A0.getZ();
-	++index;
-
-	// Générer les anneaux
-	for (int i = 1; i <= n_r; ++i)
-	{
-		double r = R * (static_cast<double>(i) / static_cast<double>(n_r)); // Rayon progressif
-		for (int j = 0; j < n; ++j)
-		{
-			double theta = 2.0 * M_PI * static_cast<double>(j) / static_cast<double>(n);
-			M[0][index] = A0.getX() + r * cosinus(theta);
-			M[1][index] = A0.getY() + r * sinus(theta);
-			M[2][index] = A0.getZ();
-			++index;
-		}
-	}
-
-	return M;
+	return Disc(R, A0, n).materialize();
 }
 
 /**
@@ -331,35 +307,7 @@ Matrix MathLib::cercle_plein(float R, const FVector3& A0, int n)
  */
 Matrix MathLib::cylindre_plein(float R, float h, const FVector3& A0, int n, int s_h)
 {
-	h = std::max<float>(h, 1);
-	n = std::max(n, 3);
-	s_h = std::max(s_h, 2);
-
-	int n_cercles = h * s_h;  // Total number of circles
-	int n_r = n;  // Number of points per radius in each circle
-	int n_total = n_cercles * (n_r * n + 1);  // Total number of points (including center)
-
-	Matrix M(3, n_total);
-	int index = 0;
-
-	for (int i = 0; i < n_cercles; ++i)
-	{
-		float z = A0.getZ() + static_cast<float>(i) / s_h;  // Height of the circle
-
-		// Generate a circle at height `z`
-		Matrix cercle = cercle_plein(R, FVector3(A0.getX(), A0.getY(), z), n);
-
-		// Add the circle to the matrix
-		for (int j = 0; j < cercle.getCols(); ++j)
-		{
-			M[0][index] = cercle[0][j];
-			M[1][index] = cercle[1][j];
-			M[2][index] = cercle[2][j];
-			++index;
-		}
-	}
-
-	return M;
+	return Cylinder(R, h, A0, n, s_h).materialize();
 }
 
 /**
@@ -409,6 +357,47 @@ MovementResult MathLib::mouvement(Matrix W, float m, Matrix I, FVector3 G, FVect
 	return { newW, newG, newV, newAngles, newAngularVel };
 }
 
+/**
+ * Move a solid over n steps and record its pose every pas steps
+ * Only the poses are stored, the points of any frame are rebuilt from the initial solid with Trajectory::frame
+ * The solid is stepped by RigidBody: unlike MathLib::mouvement, which keeps I fixed in the world frame, the inverse
+ * inertia turns with the solid (R * I_corps^-1 * Rt), so a rotating solid does not follow the same motion
+ * @param W : Solid matrix
+ * @param m : Mass
+ * @param I : Inertia matrix
+ * @param G : Center of gravity
+ * @param v : Linear speed
+ * @param teta : Angular vector
+ * @param tetap : Angular speed
+ * @param F : List of forces
+ * @param A : List of application points
+ * @param h : Time step
+ * @param n : Number of steps
+ * @param pas : Number of steps between two recorded frames
+ * @return : The trajectory, its first pose is the initial state
+ */
+Trajectory MathLib::trajectoire(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+	const FVector3& teta, const FVector3& tetap, const std::vector<std::vector<FVector3>>& F,
+	const std::vector<std::vector<FVector3>>& A, float h, int n, int pas)
+{
+	Trajectory trajectoire(W, G, teta);
+	trajectoire.reserve(static_cast<std::size_t>(n / std::max(pas, 1)) + 1);
+
+	// Only the kinematics are integrated, the points are placed from the poses
+	RigidBody corps(Matrix(3, 0), m, I, G, v, teta, tetap);
+	TrajectorySink sink(trajectoire);
+	simuler(corps, F, A, h, n, pas, sink);
+	return trajectoire;
+}
+
+/**
+ * Move a solid over a duration and keep the solid matrix at n evenly spaced times
+ * Each frame is one step of MathLib::mouvement, with the inertia fixed in the world frame
+ * @param h : Unused, the time step is t / n
+ * @param t : Duration of the motion
+ * @param n : Number of frames
+ * @return : The solid matrix at each frame
+ */
 std::vector<Matrix> MathLib::trace_mouvements(Matrix W, float m, Matrix I, FVector3 G, FVector3 v, FVector3 teta,
 	FVector3 tetap, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h,
 	float t, int n)
@@ -436,3 +425,84 @@ std::vector<Matrix> MathLib::trace_mouvements(Matrix W, float m, Matrix I, FVect
 
 	return snapshots;
 }
+
+/**
+ * Same frames as MathLib::trace_mouvements, with the dynamics of RigidBody
+ * The inertia follows the orientation (R * I_corps * Rt), so a rotating solid does not move as with MathLib::mouvement.
+ * The matrices are rebuilt from the poses of MathLib::trajectoire, prefer it or MathLib::simuler when the points
+ * are not all needed
+ * @param h : Internal time step, rounded so that t / n is a whole number of steps
+ * @param t : Duration of the motion
+ * @param n : Number of frames
+ * @return : The solid matrix at each frame
+ */
+std::vector<Matrix> MathLib::trace_mouvements_corps(const Matrix& W, float m, const Matrix& I, const FVector3& G,
+	const FVector3& v, const FVector3& teta, const FVector3& tetap, const std::vector<std::vector<FVector3>>& F,
+	const std::vector<std::vector<FVector3>>& A, float h, float t, int n)
+{
+	// Internal steps between two frames
+	const float intervalle = t / static_cast<float>(n);
+	const int pas = h > 0 ? std::max(1, static_cast<int>(std::lround(intervalle / h))) : 1;
+	const Trajectory poses = trajectoire(W, m, I, G, v, teta, tetap, F, A, intervalle / static_cast<float>(pas), n * pas, pas);
+
+	// Vector to store the snapshots
+	std::vector<Matrix> snapshots;
+	snapshots.reserve(n);
+	for (int i = 1; i <= n; i++)
+		snapshots.push_back(poses.frame(i));
+
+	return snapshots;
+}
+
+/**
+ * Move a solid with an adaptive time step and sample it at the requested times
+ * The step follows the local error of an embedded Runge-Kutta pair, so calm phases take long steps
+ * and only the violent ones pay for short steps
+ * @param W : Solid matrix
+ * @param m : Mass
+ * @param I : Inertia matrix
+ * @param G : Center of gravity
+ * @param v : Linear speed
+ * @param teta : Angular vector
+ * @param tetap : Angular speed
+ * @param F : List of forces
+ * @param A : List of application points
+ * @param temps : Output times, increasing and positive
+ * @param options : Tolerances and step limits
+ * @return : The states and solid matrices at the output times, with the cost of the integration
+ */
+AdaptiveResult MathLib::trace_mouvements(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+	const FVector3& teta, const FVector3& tetap, const std::vector<std::vector<FVector3>>& F,
+	const std::vector<std::vector<FVector3>>& A, const std::vector<float>& temps, const AdaptiveOptions& options)
+{
+	// Only the kinematics are integrated, the solid is placed at the output times
+	RigidBody corps(Matrix(3, 0), m, I, G, v, teta, tetap);
+	corps.setForces(F, A);
+
+	AdaptiveResult result;
+	result.temps.reserve(temps.size());
+	result.etats.reserve(temps.size());
+	result.snapshots.reserve(temps.size());
+
+	// Rotation from the initial orientation, applied to the initial solid, built from quaternions so any angle gives a rotation
+	const FQuaternion q0t = FQuaternion::fromEuler(teta).conjugate();
+	const auto sortie = [&](float t, const MotionState& e)
+	{
+		// R (W - G0) + G, with R the rotation from the initial orientation
+		const FMatrix3 R = (FQuaternion::fromEuler(e.teta) * q0t).toRotationMatrix();
+		Matrix snapshot(3, W.getCols());
+		transforme_points(W, snapshot, R, e.G - R * G);
+		result.temps.push_back(t);
+		result.etats.push_back(e);
+		result.snapshots.push_back(std::move(snapshot));
+	};
+	const auto acceleration = [&](const MotionState& e)
+	{
+		++result.evaluations;
+		return corps.acceleration(e);
+	};
+
+	Integrators::integrerAdaptatif(corps.getMotionState(), acceleration, 0.f, temps, options, sortie,
+		result.pasAcceptes, result.pasRejetes);
+	return result;
+}
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "Matrix.h"
+#include "FMatrix3.h"
 #include "FVector3.h"
 #include "StructHeader.h"
 
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <stdexcept>
 #include <vector>
 
 #ifndef M_PI
@@ -11,27 +16,331 @@
 #endif
 
 struct MovementResult;
+class Shape;
+class Trajectory;
+struct Moments;
 
 namespace MathLib
 {
+	// Fixed 3xN set of points known at compile time, same layout as the Matrix returned by the shape generators
+	template<std::size_t N>
+	using PointsFixes = std::array<std::array<float, N>, 3>;
+
 	void printMatrix(const Matrix& m, const char* text = "Matrix :");
-	float solve1(float f, float fp, float h);
-	double truncate(double value, int precision = 5);
-	double roundToPrecision(double value, int precision = 5);
-	unsigned long long factoriel(unsigned int n);
-	double cosinus(double x, int n = 15);
-	double sinus(double x, int n = 15);
+	// Solve equation f + f' * h, the explicit update shared by translation, rotation and World
+	constexpr float solve1(float f, float fp, float h)
+	{
+		return f + fp * h;
+	}
+
+	constexpr FVector3 solve1(const FVector3& f, const FVector3& fp, float h)
+	{
+		return { solve1(f.getX(), fp.getX(), h), solve1(f.getY(), fp.getY(), h), solve1(f.getZ(), fp.getZ(), h) };
+	}
+
 	DoubleVector3 translation(float m, float h, const FVector3& F, const FVector3& G, const FVector3& v);
     DoubleVector3 rotation(float h, const std::vector<FVector3>& F, const std::vector<FVector3>& A, const FVector3& G, const Matrix& I, const FVector3& teta, const FVector3& tetap);
+	DoubleVector3 rotation(float h, const FVector3& torque, const FMatrix3& I_inv, const FVector3& teta, const FVector3& tetap);
+	FVector3 moment_total(const std::vector<FVector3>& F, const std::vector<FVector3>& A, const FVector3& G);
+	Moments moments(const std::vector<FVector3>& L);
+	Moments moments(const Shape& S);
 	FVector3 centre_inert(const std::vector<FVector3>& L);
 	Matrix matrice_inert(const std::vector<FVector3>& L, float m);
+	FVector3 centre_inert(const Shape& S);
+	Matrix matrice_inert(const Shape& S, float m);
 	Matrix deplace_matrix(const Matrix& I, float m, const FVector3& O, const FVector3& A);
 	Matrix rotation_forme(Matrix W, const FVector3& G, const FVector3& teta);
+	void transforme_points(Matrix& W, const FMatrix3& R, const FVector3& G, const FVector3& t = FVector3::Zero());
+	void transforme_points(const Matrix& source, Matrix& W, const FMatrix3& R, const FVector3& T);
 	Matrix pave_plein(unsigned int n,float a,float b,float c,const FVector3& A0);
+	Matrix pave_plein(int nx, int ny, int nz, float a, float b, float c, const FVector3& A0);
 	Matrix cercle_plein(float R,const FVector3& A0, int n = 8);
 	Matrix cylindre_plein(float R, float h, const FVector3& A0, int n = 8, int s_h = 6);
 	MovementResult mouvement(Matrix W, float m, Matrix I, FVector3 G, FVector3 v, FVector3 teta, FVector3 tetap,
 		std::vector<std::vector<FVector3>> F, std::vector<std::vector<FVector3>> A, float h);
+	Trajectory trajectoire(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v, const FVector3& teta,
+		const FVector3& tetap, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h, int n,
+		int pas = 1);
 	std::vector<Matrix> trace_mouvements(Matrix W, float m, Matrix I, FVector3 G, FVector3 v, FVector3 teta, FVector3 tetap,
 		const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h, float t, int n);
+	std::vector<Matrix> trace_mouvements_corps(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+		const FVector3& teta, const FVector3& tetap, const std::vector<std::vector<FVector3>>& F,
+		const std::vector<std::vector<FVector3>>& A, float h, float t, int n);
+	AdaptiveResult trace_mouvements(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+		const FVector3& teta, const FVector3& tetap, const std::vector<std::vector<FVector3>>& F,
+		const std::vector<std::vector<FVector3>>& A, const std::vector<float>& temps, const AdaptiveOptions& options = {});
+
+	// Largest n for which n! still fits in an unsigned long long
+	constexpr unsigned int FACTORIEL_MAX = 20;
+	// Number of 1/k! coefficients precomputed for the Taylor series of cosinus and sinus
+	constexpr int TAYLOR_COEFFS = 40;
+	// Powers of ten that are exactly representable as a double
+	constexpr int POW10_MAX = 22;
+
+	constexpr std::array<unsigned long long, FACTORIEL_MAX + 1> makeFactorielTable()
+	{
+		std::array<unsigned long long, FACTORIEL_MAX + 1> table{};
+		table[0] = 1;
+		for (unsigned int i = 1; i <= FACTORIEL_MAX; ++i)
+		{
+			if (table[i - 1] > ULLONG_MAX / i)
+				throw std::overflow_error("FACTORIEL_MAX is too large for unsigned long long");
+			table[i] = table[i - 1] * i;
+		}
+		return table;
+	}
+
+	constexpr std::array<double, TAYLOR_COEFFS> makeInvFactorielTable()
+	{
+		std::array<double, TAYLOR_COEFFS> table{};
+		table[0] = 1.0;
+		for (int i = 1; i < TAYLOR_COEFFS; ++i)
+			table[i] = table[i - 1] / i;
+		return table;
+	}
+
+	constexpr std::array<double, POW10_MAX + 1> makePow10Table()
+	{
+		std::array<double, POW10_MAX + 1> table{};
+		table[0] = 1.0;
+		for (int i = 1; i <= POW10_MAX; ++i)
+			table[i] = table[i - 1] * 10.0;
+		return table;
+	}
+
+	// k! for k in [0, FACTORIEL_MAX]
+	inline constexpr auto FACTORIEL_TABLE = makeFactorielTable();
+	// 1/k! for k in [0, TAYLOR_COEFFS[
+	inline constexpr auto INV_FACTORIEL_TABLE = makeInvFactorielTable();
+	// 10^k for k in [0, POW10_MAX]
+	inline constexpr auto POW10_TABLE = makePow10Table();
+
+	static_assert(FACTORIEL_TABLE[FACTORIEL_MAX] > ULLONG_MAX / (FACTORIEL_MAX + 1),
+		"FACTORIEL_MAX must be the last factorial that fits in an unsigned long long");
+
+	// Factorial function, throws (or fails to compile in a constant expression) when n! overflows
+	constexpr unsigned long long factoriel(unsigned int n)
+	{
+		if (n > FACTORIEL_MAX)
+			throw std::overflow_error("factoriel(n) overflows unsigned long long for n > 20");
+		return FACTORIEL_TABLE[n];
+	}
+
+	// 10^precision, read from POW10_TABLE when possible
+	constexpr double pow10(int precision)
+	{
+		if (precision >= 0 && precision <= POW10_MAX)
+			return POW10_TABLE[precision];
+		double factor = 1.0;
+		for (int i = 0; i < precision; ++i)
+			factor *= 10.0;
+		for (int i = 0; i > precision; --i)
+			factor /= 10.0;
+		return factor;
+	}
+
+	// std::floor usable in constant expressions
+	constexpr double constexprFloor(double value)
+	{
+		// Past 2^63 every double is already an integer (this also lets NaN and infinities through)
+		if (!(value > -9.2e18 && value < 9.2e18))
+			return value;
+		const double t = static_cast<double>(static_cast<long long>(value));
+		return t > value ? t - 1.0 : t;
+	}
+
+	// std::round usable in constant expressions (halfway cases away from zero)
+	constexpr double constexprRound(double value)
+	{
+		if (value < 0)
+			return -constexprRound(-value);
+		const double t = constexprFloor(value);
+		return value - t >= 0.5 ? t + 1.0 : t;
+	}
+
+	constexpr double truncate(double value, int precision = 5)
+	{
+		const double factor = pow10(precision);
+		return constexprFloor(value * factor) / factor;
+	}
+
+	constexpr double roundToPrecision(double value, int precision = 5)
+	{
+		const double factor = pow10(precision);
+		return constexprRound(value * factor) / factor;
+	}
+
+	/**
+	 * Angle brought back to [-pi, pi] by a whole number of turns
+	 * The Taylor series only converge in a few terms near 0: unreduced, 15 terms give cosinus(20) = 2.85e6
+	 * @param x : angle
+	 * @return : x - 2 pi k, in [-pi, pi]
+	 */
+	constexpr double reduireAngle(double x)
+	{
+		constexpr double tour = 2.0 * M_PI;
+		return x - tour * constexprFloor(x / tour + 0.5);
+	}
+
+	/**
+	 * Cosinus function
+	 * @param x : number
+	 * @param n : iterations
+	 * @return : cosinus of x
+	 */
+	constexpr double cosinus(double x, int n = 15)
+	{
+		x = reduireAngle(x);
+		const double x2 = x * x;
+		n = n < 1 ? 1 : n;
+		// Horner scheme on the precomputed coefficients (-1)^i / (2i)!
+		if (2 * n - 2 < TAYLOR_COEFFS)
+		{
+			double cos_x = 0.0;
+			for (int i = n - 1; i >= 0; --i)
+				cos_x = cos_x * x2 + (i % 2 == 0 ? INV_FACTORIEL_TABLE[2 * i] : -INV_FACTORIEL_TABLE[2 * i]);
+			return cos_x;
+		}
+		double cos_x = 1.0; // First term of the Taylor series
+		double term = 1.0;
+		int sign = -1;
+		for (int i = 1; i < n; ++i)
+		{
+			term *= x2 / ((2 * i - 1) * (2 * i));
+			cos_x += sign * term;
+			sign = -sign;
+		}
+		return cos_x;
+	}
+
+	/**
+	 * Sinus function
+	 * @param x : number
+	 * @param n : iterations
+	 * @return : sinus of x
+	 */
+	constexpr double sinus(double x, int n = 15)
+	{
+		x = reduireAngle(x);
+		const double x2 = x * x;
+		n = n < 1 ? 1 : n;
+		// Horner scheme on the precomputed coefficients (-1)^i / (2i+1)!
+		if (2 * n - 1 < TAYLOR_COEFFS)
+		{
+			double sin_x = 0.0;
+			for (int i = n - 1; i >= 0; --i)
+				sin_x = sin_x * x2 + (i % 2 == 0 ? INV_FACTORIEL_TABLE[2 * i + 1] : -INV_FACTORIEL_TABLE[2 * i + 1]);
+			return sin_x * x;
+		}
+		double sin_x = x; // First term of the Taylor series
+		double term = x;
+		int sign = -1;
+		for (int i = 1; i < n; ++i)
+		{
+			term *= x2 / ((2 * i) * (2 * i + 1));
+			sin_x += sign * term;
+			sign = -sign;
+		}
+		return sin_x;
+	}
+
+	/**
+	 * Build the rotation matrix Rz * Ry * Rx used by rotation_forme
+	 * @param teta : angles around X, Y and Z
+	 * @return : Combined rotation matrix
+	 */
+	constexpr FMatrix3 matrice_rotation(const FVector3& teta)
+	{
+		const float cX = static_cast<float>(cosinus(teta.getX()));
+		const float sX = static_cast<float>(sinus(teta.getX()));
+		const float cY = static_cast<float>(cosinus(teta.getY()));
+		const float sY = static_cast<float>(sinus(teta.getY()));
+		const float cZ = static_cast<float>(cosinus(teta.getZ()));
+		const float sZ = static_cast<float>(sinus(teta.getZ()));
+		const FMatrix3 Rx = {
+			1, 0, 0,
+			0, cX, -sX,
+			0, sX,  cX
+		};
+		const FMatrix3 Ry = {
+			 cY, 0, sY,
+			  0, 1,  0,
+			-sY, 0, cY
+		};
+		const FMatrix3 Rz = {
+			 cZ, -sZ, 0,
+			 sZ,  cZ, 0,
+			  0,   0, 1
+		};
+		return Rz * Ry * Rx;
+	}
+
+	/**
+	 * Compile-time version of pave_plein with I points along each edge
+	 * @param a : length
+	 * @param b : width
+	 * @param c : height
+	 * @param A0 : first point
+	 * @return : I^3 points with 3 rows representing the coordinates X, Y and Z
+	 */
+	template<int I>
+	constexpr PointsFixes<I * I * I> pave_plein_fixe(float a, float b, float c, const FVector3& A0)
+	{
+		static_assert(I >= 2, "pave_plein_fixe needs at least 2 points per edge");
+		const float dx = a / (I - 1);
+		const float dy = b / (I - 1);
+		const float dz = c / (I - 1);
+		PointsFixes<I * I * I> P{};
+		int index = 0;
+		for (int i = 0; i < I; ++i)
+			for (int j = 0; j < I; ++j)
+				for (int k = 0; k < I; ++k)
+				{
+					P[0][index] = A0.getX() + i * dx;
+					P[1][index] = A0.getY() + j * dy;
+					P[2][index] = A0.getZ() + k * dz;
+					++index;
+				}
+		return P;
+	}
+
+	/**
+	 * Compile-time version of cercle_plein with N rings of N points
+	 * @param R : radius
+	 * @param A0 : center
+	 * @return : N*N+1 points with 3 rows representing the coordinates X, Y and Z
+	 */
+	template<int N>
+	constexpr PointsFixes<N * N + 1> cercle_plein_fixe(float R, const FVector3& A0)
+	{
+		static_assert(N >= 3, "cercle_plein_fixe needs at least 3 points per ring");
+		PointsFixes<N * N + 1> P{};
+		P[0][0] = A0.getX();
+		P[1][0] = A0.getY();
+		P[2][0] = A0.getZ();
+		int index = 1;
+		for (int i = 1; i <= N; ++i)
+		{
+			const double r = R * (static_cast<double>(i) / N);
+			for (int j = 0; j < N; ++j)
+			{
+				const double theta = 2.0 * M_PI * static_cast<double>(j) / N;
+				P[0][index] = static_cast<float>(A0.getX() + r * cosinus(theta));
+				P[1][index] = static_cast<float>(A0.getY() + r * sinus(theta));
+				P[2][index] = A0.getZ();
+				++index;
+			}
+		}
+		return P;
+	}
+
+	// Copy a fixed set of points into a 3xN Matrix
+	template<std::size_t N>
+	Matrix toMatrix(const PointsFixes<N>& P)
+	{
+		Matrix M(3, static_cast<int>(N));
+		for (int i = 0; i < 3; ++i)
+			std::copy(P[i].begin(), P[i].end(), M[i]);
+		return M;
+	}
 }
@@ -0,0 +1,187 @@
+#include "Moments.h"
+
+namespace
+{
+	/**
+	 * Reduce up to Moments::BLOC points with LANES independent accumulators, so the loop maps onto vector registers
+	 * The lanes are combined in a fixed order, the result does not depend on who calls the kernel
+	 * @param count : number of points
+	 * @param x, y, z : accessors returning the coordinates of the i-th point
+	 */
+	template<class GetX, class GetY, class GetZ>
+	Moments reduireBloc(std::size_t count, GetX x, GetY y, GetZ z)
+	{
+		constexpr int LANES = 4;
+		double sx[LANES] = {}, sy[LANES] = {}, sz[LANES] = {};
+		double sxx[LANES] = {}, syy[LANES] = {}, szz[LANES] = {};
+		double syz[LANES] = {}, sxz[LANES] = {}, sxy[LANES] = {};
+
+		std::size_t i = 0;
+		for (; i + LANES <= count; i += LANES)
+		{
+			for (int l = 0; l < LANES; ++l)
+			{
+				const double px = x(i + l);
+				const double py = y(i + l);
+				const double pz = z(i + l);
+				sx[l] += px;
+				sy[l] += py;
+				sz[l] += pz;
+				sxx[l] += px * px;
+				syy[l] += py * py;
+				szz[l] += pz * pz;
+				syz[l] += py * pz;
+				sxz[l] += px * pz;
+				sxy[l] += px * py;
+			}
+		}
+
+		Moments M;
+		M.n = static_cast<double>(count);
+		for (int l = 0; l < LANES; ++l)
+		{
+			M.sx += sx[l];
+			M.sy += sy[l];
+			M.sz += sz[l];
+			M.sxx += sxx[l];
+			M.syy += syy[l];
+			M.szz += szz[l];
+			M.syz += syz[l];
+			M.sxz += sxz[l];
+			M.sxy += sxy[l];
+		}
+		for (; i < count; ++i)
+		{
+			const double px = x(i);
+			const double py = y(i);
+			const double pz = z(i);
+			M.sx += px;
+			M.sy += py;
+			M.sz += pz;
+			M.sxx += px * px;
+			M.syy += py * py;
+			M.szz += pz * pz;
+			M.syz += py * pz;
+			M.sxz += px * pz;
+			M.sxy += px * py;
+		}
+		return M;
+	}
+}
+
+Moments& Moments::operator+=(const Moments& other)
+{
+	n += other.n;
+	sx += other.sx;
+	sy += other.sy;
+	sz += other.sz;
+	sxx += other.sxx;
+	syy += other.syy;
+	szz += other.szz;
+	syz += other.syz;
+	sxz += other.sxz;
+	sxy += other.sxy;
+	return *this;
+}
+
+Moments& Moments::operator-=(const Moments& other)
+{
+	n -= other.n;
+	sx -= other.sx;
+	sy -= other.sy;
+	sz -= other.sz;
+	sxx -= other.sxx;
+	syy -= other.syy;
+	szz -= other.szz;
+	syz -= other.syz;
+	sxz -= other.sxz;
+	sxy -= other.sxy;
+	return *this;
+}
+
+Moments Moments::operator+(const Moments& other) const
+{
+	Moments result = *this;
+	return result += other;
+}
+
+Moments Moments::operator*(double value) const
+{
+	Moments result = *this;
+	result.n *= value;
+	result.sx *= value;
+	result.sy *= value;
+	result.sz *= value;
+	result.sxx *= value;
+	result.syy *= value;
+	result.szz *= value;
+	result.syz *= value;
+	result.sxz *= value;
+	result.sxy *= value;
+	return result;
+}
+
+FVector3 Moments::centre() const
+{
+	return { static_cast<float>(sx / n), static_cast<float>(sy / n), static_cast<float>(sz / n) };
+}
+
+/**
+ * Inertia matrix about the origin, same convention as MathLib::matrice_inert
+ * @param m : Total mass
+ * @return : The inertia matrix
+ */
+Matrix Moments::inertie(float m) const
+{
+	const double massPerPoint = m / n;
+	const auto A = static_cast<float>((syy + szz) * massPerPoint);
+	const auto B = static_cast<float>((sxx + szz) * massPerPoint);
+	const auto C = static_cast<float>((sxx + syy) * massPerPoint);
+	const auto D = static_cast<float>(syz * massPerPoint);
+	const auto E = static_cast<float>(sxz * massPerPoint);
+	const auto F = static_cast<float>(sxy * massPerPoint);
+	return {
+		{  A, -F, -E },
+		{ -F,  B, -D },
+		{ -E, -D,  C }
+	};
+}
+
+Moments Moments::bloc(const float* X, const float* Y, const float* Z, std::size_t count)
+{
+	return reduireBloc(count,
+		[X](std::size_t i) { return X[i]; },
+		[Y](std::size_t i) { return Y[i]; },
+		[Z](std::size_t i) { return Z[i]; });
+}
+
+Moments Moments::bloc(const FVector3* P, std::size_t count)
+{
+	return reduireBloc(count,
+		[P](std::size_t i) { return P[i].getX(); },
+		[P](std::size_t i) { return P[i].getY(); },
+		[P](std::size_t i) { return P[i].getZ(); });
+}
+
+void MomentsPairwise::push(const Moments& m)
+{
+	std::size_t leaves = 1;
+	Moments sum = m;
+	// Merge with the partial sums covering the same number of leaves
+	while (!stack.empty() && stack.back().first == leaves)
+	{
+		sum = stack.back().second + sum;
+		leaves *= 2;
+		stack.pop_back();
+	}
+	stack.emplace_back(leaves, sum);
+}
+
+Moments MomentsPairwise::result() const
+{
+	// Fold the remaining partial sums from the smallest to the largest
+	Moments total;
+	for (auto it = stack.rbegin(); it != stack.rend(); ++it)
+		total = it->second + total;
+	return total;
+}
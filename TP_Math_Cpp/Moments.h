@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FVector3.h"
+#include "Matrix.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * First and second moments of a set of points: number of points, sums of the coordinates and of their products
+ * Sums are kept in double, the product of two floats is exact in double
+ */
+struct Moments
+{
+	double n = 0;
+	double sx = 0, sy = 0, sz = 0;
+	double sxx = 0, syy = 0, szz = 0;
+	double syz = 0, sxz = 0, sxy = 0;
+
+	// Number of points reduced by a single call of the leaf kernels, the reduction tree only depends on it
+	static constexpr std::size_t BLOC = 1024;
+
+	Moments& operator+=(const Moments& other);
+	Moments& operator-=(const Moments& other);
+	Moments operator+(const Moments& other) const;
+	Moments operator*(double value) const;
+
+	// Center of inertia of the points
+	FVector3 centre() const;
+	// Inertia matrix about the origin for a total mass m spread evenly on the points
+	Matrix inertie(float m) const;
+
+	// Leaf kernels, reduce up to BLOC points
+	static Moments bloc(const float* X, const float* Y, const float* Z, std::size_t count);
+	static Moments bloc(const FVector3* P, std::size_t count);
+};
+
+/**
+ * Pairwise (cascade) sum of Moments, fed in order
+ * Two partial sums are merged as soon as they cover the same number of leaves, like a binary counter,
+ * so the rounding only grows with log(n) and the result only depends on the order of the leaves
+ */
+class MomentsPairwise
+{
+public:
+	void push(const Moments& m);
+	Moments result() const;
+
+private:
+	// Partial sums with the number of leaves they cover, strictly decreasing from the bottom
+	std::vector<std::pair<std::size_t, Moments>> stack;
+};
@@ -0,0 +1,35 @@
+#include "Parallel.h"
+
+#include <atomic>
+
+namespace
+{
+	std::atomic<ThreadPool*> poolExterne{ nullptr };
+}
+
+ThreadPool& MathLib::threadPool()
+{
+	if (ThreadPool* pool = poolExterne.load())
+		return *pool;
+	static ThreadPool defaut;
+	return defaut;
+}
+
+/**
+ * Make the parallel helpers run on a pool shared with the rest of the application
+ * The pool stays owned by the caller and must outlive its use by MathLib
+ * @param pool : Pool to use, nullptr for the default one
+ */
+void MathLib::setThreadPool(ThreadPool* pool)
+{
+	poolExterne.store(pool);
+}
+
+/**
+ * Number of threads the parallel helpers may use
+ * @return : Size of the current pool, at least 1
+ */
+unsigned int MathLib::nombreThreads()
+{
+	return threadPool().size();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace MathLib
+{
+	// Default number of items (points, bodies...) a thread should at least receive
+	constexpr std::size_t PARALLEL_GRAIN = 1 << 16;
+
+	// Pool used by the parallel helpers: the one given to setThreadPool, or a default pool over every processor
+	ThreadPool& threadPool();
+	// Share a pool owned by the caller with MathLib, nullptr goes back to the default pool
+	void setThreadPool(ThreadPool* pool);
+	unsigned int nombreThreads();
+
+	/**
+	 * Split [begin, end[ into contiguous slabs and run f(first, last) on each of them in parallel
+	 * There are a few slabs per thread so the pool can balance them, small ranges never leave the calling thread
+	 * @param begin : first index
+	 * @param end : one past the last index
+	 * @param grain : minimum number of indices per slab
+	 * @param f : callable taking (std::size_t first, std::size_t last)
+	 */
+	template<class Function>
+	void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, Function&& f)
+	{
+		if (end <= begin)
+			return;
+		const std::size_t count = end - begin;
+		const std::size_t slabs = std::min<std::size_t>(4 * static_cast<std::size_t>(nombreThreads()),
+			std::max<std::size_t>(count / std::max<std::size_t>(grain, 1), 1));
+		if (slabs == 1)
+		{
+			f(begin, end);
+			return;
+		}
+
+		auto slab = [&](std::size_t s) { f(begin + count * s / slabs, begin + count * (s + 1) / slabs); };
+		threadPool().executer(slabs, slab);
+	}
+
+	/**
+	 * Reduce [begin, end[ in parallel: map(first, last) reduces a chunk, combine(a, b) merges two results
+	 * The chunks only depend on the grain and are merged pairwise in order, so the result does not depend on the
+	 * number of threads, even for a combine that is not associative in floating point
+	 * @param begin : first index
+	 * @param end : one past the last index
+	 * @param grain : number of indices per chunk, also the smallest piece of work given to a thread
+	 * @param identite : result of an empty range
+	 * @param map : callable taking (std::size_t first, std::size_t last) and returning a T
+	 * @param combine : callable taking (const T&, const T&) and returning a T
+	 * @return : The reduced value
+	 */
+	template<class T, class Map, class Combine>
+	T parallel_reduce(std::size_t begin, std::size_t end, std::size_t grain, const T& identite, Map&& map, Combine&& combine)
+	{
+		if (end <= begin)
+			return identite;
+		grain = std::max<std::size_t>(grain, 1);
+		const std::size_t chunks = (end - begin + grain - 1) / grain;
+		std::vector<T> partiels(chunks, identite);
+		// A chunk may be a whole simulation, so every chunk can be a task of its own: the grain already sized them
+		parallel_for(0, chunks, 1, [&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t c = first; c < last; ++c)
+				partiels[c] = map(begin + c * grain, std::min(end, begin + (c + 1) * grain));
+		});
+
+		// Pairwise tree, level by level
+		for (std::size_t largeur = 1; largeur < chunks; largeur *= 2)
+			for (std::size_t i = 0; i + largeur < chunks; i += 2 * largeur)
+				partiels[i] = combine(partiels[i], partiels[i + largeur]);
+		return partiels[0];
+	}
+}
@@ -0,0 +1,145 @@
+#include "Pipeline.h"
+
+#include <stdexcept>
+
+namespace
+{
+	/**
+	 * Wait for the other end of a queue: spin a little, then give the core away
+	 * @param essais : Number of failed attempts so far, reset by the caller once the queue moved
+	 */
+	void attendre(int& essais)
+	{
+		if (++essais > 64)
+			std::this_thread::yield();
+	}
+}
+
+PipelineSink::PipelineSink(const std::string& chemin, const Matrix& W, const FVector3& G, const FVector3& teta, std::size_t capacite)
+	: file(chemin), reference(Trajectory::repereCorps(W, G, teta)), poses(capacite),
+	frames(capacite, Frame{ Pose{}, Matrix(3, W.getCols()) })
+{
+	if (!file)
+		throw std::runtime_error("Cannot open " + chemin);
+	materialisation = std::thread(&PipelineSink::materialiser, this);
+	encodage = std::thread(&PipelineSink::encoder, this);
+}
+
+PipelineSink::~PipelineSink()
+{
+	poses.fermer();
+	if (materialisation.joinable())
+		materialisation.join();
+	if (encodage.joinable())
+		encodage.join();
+}
+
+void PipelineSink::recevoir(const Pose& pose)
+{
+	Pose* slot;
+	int essais = 0;
+	while (!(slot = poses.reserver()))
+	{
+		// A stage died, the queue will never drain
+		if (arret.load(std::memory_order_acquire))
+		{
+			terminer();
+			throw std::runtime_error("Pipeline stopped");
+		}
+		attendre(essais);
+	}
+	*slot = pose;
+	poses.publier();
+}
+
+void PipelineSink::terminer()
+{
+	if (!materialisation.joinable())
+		return;
+	poses.fermer();
+	materialisation.join();
+	encodage.join();
+	file.flush();
+	if (erreurMaterialisation)
+		std::rethrow_exception(erreurMaterialisation);
+	if (erreurEncodage)
+		std::rethrow_exception(erreurEncodage);
+}
+
+void PipelineSink::arreter()
+{
+	arret.store(true, std::memory_order_release);
+}
+
+/**
+ * Second stage: place the points of the solid at each pose
+ */
+void PipelineSink::materialiser()
+{
+	try
+	{
+		int essais = 0;
+		while (!arret.load(std::memory_order_acquire))
+		{
+			const Pose* pose = poses.front();
+			if (!pose)
+			{
+				if (poses.terminee())
+					break;
+				attendre(essais);
+				continue;
+			}
+			Frame* frame = frames.reserver();
+			if (!frame)
+			{
+				attendre(essais);
+				continue;
+			}
+			essais = 0;
+			frame->pose = *pose;
+			poses.liberer();
+			Trajectory::placer(reference, frame->pose, frame->points);
+			frames.publier();
+		}
+	}
+	catch (...)
+	{
+		erreurMaterialisation = std::current_exception();
+		arreter();
+	}
+	// Let the last stage drain what was already placed
+	frames.fermer();
+}
+
+/**
+ * Third stage: encode and write each frame
+ */
+void PipelineSink::encoder()
+{
+	try
+	{
+		int essais = 0;
+		while (true)
+		{
+			const Frame* frame = frames.front();
+			if (!frame)
+			{
+				if (frames.terminee())
+					break;
+				attendre(essais);
+				continue;
+			}
+			essais = 0;
+			// Allocates the json and its text, the cost of sharing the encoding of FileSink
+			file << FileSink::encoder(frame->pose, &frame->points) << '\n';
+			frames.liberer();
+			if (!file)
+				throw std::runtime_error("Cannot write the frames");
+		}
+	}
+	catch (...)
+	{
+		erreurEncodage = std::current_exception();
+		arreter();
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "FrameSink.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <thread>
+
+/**
+ * Write the frames like FileSink with the points of the solid, in a pipeline of three threads:
+ * the simulation (the thread calling recevoir), the placement of the points and the JSON encoding with the writing.
+ * The stages are linked by bounded SpscQueue, a stage waits when the next one is late, so the memory stays bounded
+ * and the throughput is the one of the slowest stage instead of the sum of the three.
+ * Only the queues are preallocated: the encoding still builds a json object and its string for every frame
+ */
+class PipelineSink : public FrameSink
+{
+public:
+	/**
+	 * @param chemin : Path of the file
+	 * @param W : Solid at the start of the simulation
+	 * @param G : Its center of gravity
+	 * @param teta : Its angles
+	 * @param capacite : Number of frames each queue holds
+	 */
+	PipelineSink(const std::string& chemin, const Matrix& W, const FVector3& G, const FVector3& teta, std::size_t capacite = 64);
+	// Drains the queues if terminer was not called, errors are then lost
+	~PipelineSink() override;
+
+	PipelineSink(const PipelineSink&) = delete;
+	PipelineSink& operator=(const PipelineSink&) = delete;
+
+	// Waits while the first queue is full
+	void recevoir(const Pose& pose) override;
+	// Waits for the last frame to be written, rethrows the error of a stage
+	void terminer() override;
+
+private:
+	// Solid placed at a pose, the buffer of the points is allocated once per slot
+	struct Frame
+	{
+		Pose pose;
+		Matrix points;
+	};
+
+	void materialiser();
+	void encoder();
+	void arreter();
+
+	std::ofstream file;
+	Matrix reference;  // Solid in the body frame
+	SpscQueue<Pose> poses;
+	SpscQueue<Frame> frames;
+
+	// Set by a stage that failed, so that the others stop waiting for it
+	std::atomic<bool> arret{ false };
+	// Written by their stage, only read once it is joined
+	std::exception_ptr erreurMaterialisation;
+	std::exception_ptr erreurEncodage;
+
+	std::thread materialisation;
+	std::thread encodage;
+};
@@ -0,0 +1,148 @@
+#include "RigidBody.h"
+
+#include "ForceField.h"
+#include "MathLib.h"
+#include "Trajectory.h"
+
+#include <stdexcept>
+
+RigidBodyState::RigidBodyState(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+	const FVector3& teta, const FVector3& tetap)
+	: W(W), m(m), I(FMatrix3::fromMatrix(I)), G(G), v(v), teta(teta), tetap(tetap)
+{
+}
+
+RigidBody::RigidBody(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+	const FVector3& teta, const FVector3& tetap)
+	: state(W, m, I, G, v, teta, tetap), reference(3, 0)
+{
+	// Bring the inertia back to the body frame: I = R * I_corps * Rt
+	R = MathLib::matrice_rotation(teta);
+	I_corps = FMatrix3::tran(R) * state.I * R;
+	I_corps_inv = FMatrix3::inverse(I_corps);
+}
+
+void RigidBodyState::aplatirForces(const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A)
+{
+	// The buffers keep their capacity
+	forcesFlat.clear();
+	pointsFlat.clear();
+	for (const auto& liste : F)
+		forcesFlat.insert(forcesFlat.end(), liste.begin(), liste.end());
+	for (const auto& liste : A)
+		pointsFlat.insert(pointsFlat.end(), liste.begin(), liste.end());
+}
+
+void RigidBody::setChamps(const std::vector<const ForceField*>& champs)
+{
+	// A body built without points, for its kinematics only, has nothing for the fields to act on
+	if (!champs.empty() && state.W.getCols() == 0)
+		throw std::invalid_argument("Force fields need a solid with points");
+	this->champs = champs;
+	if (champs.empty())
+		reference = Matrix(3, 0);
+	else if (reference.getCols() != state.W.getCols())
+		reference = Trajectory::repereCorps(state.W, state.G, state.teta);
+}
+
+FMatrix3 RigidBody::inverseInertieMonde() const
+{
+	return inverseInertie(R);
+}
+
+/**
+ * World-frame inverse inertia for any orientation, derived from the cached body-frame one
+ * @param teta : Angular vector
+ * @return : R * I_corps^-1 * Rt
+ */
+FMatrix3 RigidBody::inverseInertieMonde(const FVector3& teta) const
+{
+	return inverseInertie(orientation(teta));
+}
+
+FMatrix3 RigidBody::orientation(const FVector3& teta) const
+{
+	// The integrators evaluate the current state first, its rotation was built by the previous step
+	if (teta.getX() == state.teta.getX() && teta.getY() == state.teta.getY() && teta.getZ() == state.teta.getZ())
+		return R;
+	return MathLib::matrice_rotation(teta);
+}
+
+/**
+ * Accelerations of the solid in a given state, under the forces flattened for the current step
+ * @param e : Kinematic state
+ * @return : Linear acceleration and angular acceleration
+ */
+DoubleVector3 RigidBody::acceleration(const MotionState& e) const
+{
+	FVector3 totalForce = FVector3::Zero();
+	for (const auto& f : state.forcesFlat)
+		totalForce = totalForce + f;
+	FVector3 torque = MathLib::moment_total(state.forcesFlat, state.pointsFlat, e.G);
+	// One rotation for the fields and the inverse inertia
+	const FMatrix3 R = orientation(e.teta);
+	if (!champs.empty())
+	{
+		const DoubleVector3 charge = MathLib::force_et_moment(reference, R, e.G, e.v, e.tetap, state.m, champs);
+		totalForce = totalForce + charge.v1;
+		torque = torque + charge.v2;
+	}
+	return { totalForce / state.m, inverseInertie(R) * torque };
+}
+
+void RigidBody::appliquer(const MotionState& e)
+{
+	state.G = e.G;
+	state.v = e.v;
+	state.teta = e.teta;
+	state.tetap = e.tetap;
+
+	// Apply the rotation to the solid, and keep the world-frame inertia in sync with the new orientation
+	R = MathLib::matrice_rotation(state.teta);
+	MathLib::transforme_points(state.W, R, state.G);
+	state.I = R * I_corps * FMatrix3::tran(R);
+}
+
+/**
+ * Same update as MathLib::mouvement, done in place on the state
+ * @param s : State of the solid, updated
+ * @param F : List of forces
+ * @param A : List of application points
+ * @param h : Time step
+ */
+void MathLib::step(RigidBodyState& s, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h)
+{
+	step(s, F, A, h, FMatrix3::inverse(s.I));
+}
+
+/**
+ * Same update as MathLib::mouvement, done in place on the state, with an inverse inertia matrix provided by the caller
+ * @param s : State of the solid, updated
+ * @param F : List of forces
+ * @param A : List of application points
+ * @param h : Time step
+ * @param I_inv : Inverse of the inertia matrix
+ */
+void MathLib::step(RigidBodyState& s, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h,
+	const FMatrix3& I_inv)
+{
+	s.aplatirForces(F, A);
+
+	FVector3 totalForce = FVector3::Zero();
+	for (const auto& f : s.forcesFlat)
+		totalForce = totalForce + f;
+
+	const DoubleVector3 trans = translation(s.m, h, totalForce, s.G, s.v);
+
+	// The torque is taken about the center of gravity before the translation
+	const FVector3 torque = moment_total(s.forcesFlat, s.pointsFlat, s.G);
+	const DoubleVector3 rot = rotation(h, torque, I_inv, s.teta, s.tetap);
+
+	s.G = trans.v1;
+	s.v = trans.v2;
+	s.teta = rot.v1;
+	s.tetap = rot.v2;
+
+	// Apply the rotation to the solid
+	transforme_points(s.W, matrice_rotation(s.teta), s.G);
+}
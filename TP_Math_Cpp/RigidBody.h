@@ -0,0 +1,113 @@
+#pragma once
+
+#include "FMatrix3.h"
+#include "FVector3.h"
+#include "Integrators.h"
+#include "Matrix.h"
+
+#include <vector>
+
+class ForceField;
+
+/**
+ * State of a solid moved by MathLib::step, updated in place
+ * It owns the scratch buffers of the step, so once they have grown to the number of forces, stepping does not allocate
+ */
+struct RigidBodyState
+{
+	RigidBodyState(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+		const FVector3& teta, const FVector3& tetap);
+
+	Matrix W;        // Solid matrix
+	float m;         // Mass
+	FMatrix3 I;      // Inertia matrix
+	FVector3 G;      // Center of gravity
+	FVector3 v;      // Linear speed
+	FVector3 teta;   // Angular vector
+	FVector3 tetap;  // Angular speed
+
+	// Scratch buffers reused from one step to the next
+	std::vector<FVector3> forcesFlat;
+	std::vector<FVector3> pointsFlat;
+
+	// Flatten the lists of forces and application points into the scratch buffers
+	void aplatirForces(const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A);
+};
+
+/**
+ * Solid whose inertia is known in its own frame
+ * The body-frame inertia and its inverse are computed once, each step only rotates them with the current orientation
+ */
+class RigidBody
+{
+public:
+	// I is the inertia matrix of the solid at its initial orientation teta
+	RigidBody(const Matrix& W, float m, const Matrix& I, const FVector3& G, const FVector3& v,
+		const FVector3& teta, const FVector3& tetap);
+
+	/**
+	 * Move the solid by one time step
+	 * The accelerations are re-evaluated by the integrator, with the torque about the current G and the
+	 * world-frame inverse inertia of the current orientation
+	 * @param F : List of forces
+	 * @param A : List of application points
+	 * @param h : Time step
+	 */
+	template<class Integrator = Integrators::SemiImplicitEuler>
+	void step(const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h)
+	{
+		setForces(F, A);
+		const auto a = [this](const MotionState& e) { return acceleration(e); };
+		if constexpr (Integrators::UtiliseInertieCorps<Integrator>::value)
+			appliquer(Integrator::step(getMotionState(), a, h, I_corps));
+		else
+			appliquer(Integrator::step(getMotionState(), a, h));
+	}
+
+	// Set the forces used by acceleration, step sets them itself
+	void setForces(const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A)
+	{
+		state.aplatirForces(F, A);
+	}
+
+	/**
+	 * Force fields applied on every point of the solid in addition to the point forces, kept from one step to the next
+	 * They are evaluated on the points placed at each state the integrator asks for, so the solid needs its points:
+	 * fields given to a solid built without points are rejected
+	 * @param champs : Fields, owned by the caller, empty to remove them
+	 */
+	void setChamps(const std::vector<const ForceField*>& champs);
+
+	// Linear and angular accelerations of the solid in the state e, under the forces of the current step
+	DoubleVector3 acceleration(const MotionState& e) const;
+
+	MotionState getMotionState() const { return { state.G, state.v, state.teta, state.tetap }; }
+	const RigidBodyState& getState() const { return state; }
+	const FMatrix3& getInertieCorps() const { return I_corps; }
+	// World-frame inverse inertia R * I^-1 * Rt for the current orientation
+	FMatrix3 inverseInertieMonde() const;
+	FMatrix3 inverseInertieMonde(const FVector3& teta) const;
+
+private:
+	// Store the integrated state and move the solid accordingly
+	void appliquer(const MotionState& e);
+	// Rotation matrix of teta, the cached one when teta is the current orientation
+	FMatrix3 orientation(const FVector3& teta) const;
+	// R * I_corps^-1 * Rt
+	FMatrix3 inverseInertie(const FMatrix3& R) const { return R * I_corps_inv * FMatrix3::tran(R); }
+
+	RigidBodyState state;
+	FMatrix3 R;            // Rotation of the current orientation, built once per step
+	FMatrix3 I_corps;      // Inertia in the body frame
+	FMatrix3 I_corps_inv;  // Its inverse
+
+	std::vector<const ForceField*> champs;
+	Matrix reference;      // Points in the body frame, only kept while there are fields
+};
+
+namespace MathLib
+{
+	void step(RigidBodyState& s, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h);
+	void step(RigidBodyState& s, const std::vector<std::vector<FVector3>>& F, const std::vector<std::vector<FVector3>>& A, float h,
+		const FMatrix3& I_inv);
+}
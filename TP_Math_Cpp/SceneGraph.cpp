@@ -0,0 +1,78 @@
+#include "SceneGraph.h"
+
+#include "Matrix.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+std::size_t SceneGraph::ajouter(const Transform& local, std::size_t parent)
+{
+	if (parent != AUCUN && parent >= size())
+		throw std::out_of_range("Parent node does not exist");
+	parents.push_back(parent);
+	locaux.push_back(local);
+	mondes.push_back(local);
+	sales.push_back(1);
+	aJour = false;
+	return size() - 1;
+}
+
+void SceneGraph::reserve(std::size_t n)
+{
+	parents.reserve(n);
+	locaux.reserve(n);
+	mondes.reserve(n);
+	sales.reserve(n);
+}
+
+void SceneGraph::setLocal(std::size_t i, const Transform& local)
+{
+	if (i >= size())
+		throw std::out_of_range("Node index out of range.");
+	locaux[i] = local;
+	sales[i] = 1;
+	aJour = false;
+}
+
+void SceneGraph::deplacer(std::size_t i, const Transform& mouvement)
+{
+	if (i >= size())
+		throw std::out_of_range("Node index out of range.");
+	setLocal(i, mouvement * locaux[i]);
+}
+
+const Transform& SceneGraph::getMonde(std::size_t i)
+{
+	if (i >= size())
+		throw std::out_of_range("Node index out of range.");
+	mettreAJour();
+	return mondes[i];
+}
+
+/**
+ * A node is recomputed when it was marked or when its parent was, the mark then passes to its own children
+ * The pass only reads flags for the unchanged nodes
+ */
+void SceneGraph::mettreAJour()
+{
+	if (aJour)
+		return;
+	for (std::size_t i = 0; i < size(); i++)
+	{
+		const std::size_t p = parents[i];
+		if (p != AUCUN && sales[p])
+			sales[i] = 1;
+		if (!sales[i])
+			continue;
+		mondes[i] = p == AUCUN ? locaux[i] : mondes[p] * locaux[i];
+		++recalculs;
+	}
+	// The flags are kept during the pass so the children see them
+	std::fill(sales.begin(), sales.end(), 0);
+	aJour = true;
+}
+
+void SceneGraph::placer(std::size_t i, const Matrix& source, Matrix& W)
+{
+	getMonde(i).appliquer(source, W);
+}
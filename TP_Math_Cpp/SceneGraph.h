@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Transform.h"
+
+#include <cstddef>
+#include <vector>
+
+class Matrix;
+
+/**
+ * Hierarchy of transforms: the world transform of a node is the one of its parent composed with its local one
+ * Changing a local transform only marks the node, the world transforms are recomputed on the next read, and only
+ * for the marked nodes and their descendants.
+ * A parent is always added before its children, so one pass in index order visits every parent before its children
+ */
+class SceneGraph
+{
+public:
+	// Parent of the root nodes
+	static constexpr std::size_t AUCUN = static_cast<std::size_t>(-1);
+
+	/**
+	 * Add a node
+	 * @param local : Transform relative to the parent
+	 * @param parent : Index of the parent, AUCUN for a root node
+	 * @return : Index of the node
+	 */
+	std::size_t ajouter(const Transform& local, std::size_t parent = AUCUN);
+	void reserve(std::size_t n);
+	std::size_t size() const { return locaux.size(); }
+
+	std::size_t getParent(std::size_t i) const { return parents[i]; }
+	const Transform& getLocal(std::size_t i) const { return locaux[i]; }
+	// Replace the local transform of node i, its subtree is recomputed on the next read
+	void setLocal(std::size_t i, const Transform& local);
+	// Compose a move with the local transform of node i, in the frame of its parent
+	void deplacer(std::size_t i, const Transform& mouvement);
+
+	// World transform of node i
+	const Transform& getMonde(std::size_t i);
+	// Recompute the world transforms of the marked subtrees
+	void mettreAJour();
+	// Place the points of a solid given in the frame of node i, in one pass whatever the depth of the node
+	void placer(std::size_t i, const Matrix& source, Matrix& W);
+
+	// Number of world transforms computed since the creation, to check that unchanged subtrees are skipped
+	std::size_t getRecalculs() const { return recalculs; }
+
+private:
+	std::vector<std::size_t> parents;
+	std::vector<Transform> locaux;
+	std::vector<Transform> mondes;
+	std::vector<char> sales;  // Local transform changed since the last update
+	bool aJour = true;
+	std::size_t recalculs = 0;
+};
@@ -0,0 +1,347 @@
+#include "Shape.h"
+
+#include "MathLib.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+/**
+ * Build the full 3xN matrix of points, generated in parallel slabs
+ * @return : Matrix of points with 3 rows representing the coordinates X, Y and Z
+ */
+Matrix Shape::materialize() const
+{
+	const std::size_t n = size();
+	Matrix M(3, colonnes());
+	float* X = M[0];
+	float* Y = M[1];
+	float* Z = M[2];
+	MathLib::parallel_for(0, n, MathLib::PARALLEL_GRAIN, [&](std::size_t first, std::size_t last)
+	{
+		generate(first, last - first, X + first, Y + first, Z + first);
+	});
+	return M;
+}
+
+/**
+ * Number of columns of the materialized matrix
+ * @return : size() as an int, throws when the shape does not fit in a Matrix
+ */
+int Shape::colonnes() const
+{
+	if (size() > static_cast<std::size_t>(INT_MAX))
+		throw std::length_error("Shape is too large to be materialized, stream it with forEachChunk");
+	return static_cast<int>(size());
+}
+
+/**
+ * Generate a single point of the shape
+ * @param i : index of the point
+ * @return : The point
+ */
+FVector3 Shape::point(std::size_t i) const
+{
+	if (i >= size())
+		throw std::out_of_range("Point index out of range.");
+	float x, y, z;
+	generate(i, 1, &x, &y, &z);
+	return { x, y, z };
+}
+
+FVector3 Shape::centroid() const
+{
+	return MathLib::centre_inert(*this);
+}
+
+Matrix Shape::inertiaAtCentroid(float m) const
+{
+	// Move the streamed inertia from the origin back to the center of inertia
+	const FVector3 G = centroid();
+	return MathLib::deplace_matrix(MathLib::matrice_inert(*this, m), -m, FVector3::Zero(), G);
+}
+
+/**
+ * Inertia matrix about the origin, from the inertia at the center of inertia and the parallel axis theorem
+ * @param m : Total mass
+ * @return : The inertia matrix
+ */
+Matrix Shape::inertia(float m) const
+{
+	return MathLib::deplace_matrix(inertiaAtCentroid(m), m, centroid(), FVector3::Zero());
+}
+
+namespace
+{
+	/**
+	 * Inertia matrix of a distribution whose second central moments are independent along X, Y and Z
+	 * @param m : Total mass
+	 * @param varX : Mean of (x - Gx)^2 over the points
+	 * @param varY : Mean of (y - Gy)^2 over the points
+	 * @param varZ : Mean of (z - Gz)^2 over the points
+	 * @return : Diagonal inertia matrix about the center of inertia
+	 */
+	Matrix inertieDiagonale(float m, double varX, double varY, double varZ)
+	{
+		return {
+			{ static_cast<float>(m * (varY + varZ)), 0, 0 },
+			{ 0, static_cast<float>(m * (varX + varZ)), 0 },
+			{ 0, 0, static_cast<float>(m * (varX + varY)) }
+		};
+	}
+
+	/**
+	 * Variance of n evenly spaced values separated by d
+	 * @param n : number of values
+	 * @param d : spacing
+	 * @return : d^2 (n^2 - 1) / 12
+	 */
+	double varianceGrille(int n, double d)
+	{
+		return d * d * (static_cast<double>(n) * n - 1) / 12.0;
+	}
+}
+
+Box::Box(int nx, int ny, int nz, float a, float b, float c, const FVector3& A0)
+	: nx(nx), ny(ny), nz(nz), a(a), b(b), c(c), A0(A0)
+{
+	if (nx < 1 || ny < 1 || nz < 1)
+		throw std::invalid_argument("Box needs at least one point per axis");
+	// Calculate the intervals between points in each dimension
+	dx = nx > 1 ? a / (nx - 1) : 0;
+	dy = ny > 1 ? b / (ny - 1) : 0;
+	dz = nz > 1 ? c / (nz - 1) : 0;
+}
+
+std::size_t Box::size() const
+{
+	return static_cast<std::size_t>(nx) * ny * nz;
+}
+
+void Box::generate(std::size_t first, std::size_t count, float* X, float* Y, float* Z) const
+{
+	// Walk the (i, j) lines of nz points covered by the range
+	std::size_t index = first;
+	const std::size_t last = first + count;
+	while (index < last)
+	{
+		const std::size_t l = index / nz;
+		const int i = static_cast<int>(l / ny);
+		const int j = static_cast<int>(l % ny);
+		const int k0 = static_cast<int>(index % nz);
+		const int k1 = static_cast<int>(std::min<std::size_t>(nz, k0 + (last - index)));
+		const float x = A0.getX() + i * dx;
+		const float y = A0.getY() + j * dy;
+		for (int k = k0; k < k1; ++k, ++X, ++Y, ++Z)
+		{
+			*X = x;
+			*Y = y;
+			*Z = A0.getZ() + k * dz;
+		}
+		index += k1 - k0;
+	}
+}
+
+Matrix Box::materialize() const
+{
+	Matrix M(3, colonnes());
+	float* X = M[0];
+	float* Y = M[1];
+	float* Z = M[2];
+
+	// The Z coordinates are the same on every (i, j) line
+	std::vector<float> colonneZ(nz);
+	for (int k = 0; k < nz; ++k)
+		colonneZ[k] = A0.getZ() + k * dz;
+
+	// Each thread fills a slab of (i, j) lines
+	const std::size_t lignes = static_cast<std::size_t>(nx) * ny;
+	MathLib::parallel_for(0, lignes, std::max<std::size_t>(MathLib::PARALLEL_GRAIN / nz, 1), [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t l = first; l < last; ++l)
+		{
+			const std::size_t offset = l * nz;
+			const int i = static_cast<int>(l / ny);
+			const int j = static_cast<int>(l % ny);
+			std::fill_n(X + offset, nz, A0.getX() + i * dx);
+			std::fill_n(Y + offset, nz, A0.getY() + j * dy);
+			std::copy_n(colonneZ.data(), nz, Z + offset);
+		}
+	});
+	return M;
+}
+
+FVector3 Box::centroid() const
+{
+	return {
+		static_cast<float>(A0.getX() + 0.5 * dx * (nx - 1)),
+		static_cast<float>(A0.getY() + 0.5 * dy * (ny - 1)),
+		static_cast<float>(A0.getZ() + 0.5 * dz * (nz - 1))
+	};
+}
+
+Matrix Box::inertiaAtCentroid(float m) const
+{
+	// The lattice is a product of three evenly spaced axes, so the products of inertia vanish
+	return inertieDiagonale(m, varianceGrille(nx, dx), varianceGrille(ny, dy), varianceGrille(nz, dz));
+}
+
+Disc::Disc(float R, const FVector3& A0, int n)
+	: R(R), A0(A0), n(std::max(n, 3)), cosT(this->n), sinT(this->n)
+{
+	// The unit ring is computed once, every ring is then only a scale and an offset of it
+	for (int j = 0; j < this->n; ++j)
+	{
+		double theta = 2.0 * M_PI * static_cast<double>(j) / static_cast<double>(this->n);
+		cosT[j] = MathLib::cosinus(theta);
+		sinT[j] = MathLib::sinus(theta);
+	}
+}
+
+std::size_t Disc::size() const
+{
+	return static_cast<std::size_t>(n) * n + 1;
+}
+
+void Disc::generateXY(std::size_t first, std::size_t count, float* X, float* Y) const
+{
+	std::size_t index = first;
+	const std::size_t last = first + count;
+	// Center
+	if (index == 0 && index < last)
+	{
+		*X++ = A0.getX();
+		*Y++ = A0.getY();
+		++index;
+	}
+	// Rings
+	while (index < last)
+	{
+		const std::size_t i = (index - 1) / n + 1;
+		const int j0 = static_cast<int>((index - 1) % n);
+		const int j1 = static_cast<int>(std::min<std::size_t>(n, j0 + (last - index)));
+		double r = R * (static_cast<double>(i) / static_cast<double>(n)); // Rayon progressif
+		for (int j = j0; j < j1; ++j)
+		{
+			*X++ = static_cast<float>(A0.getX() + r * cosT[j]);
+			*Y++ = static_cast<float>(A0.getY() + r * sinT[j]);
+		}
+		index += j1 - j0;
+	}
+}
+
+void Disc::generate(std::size_t first, std::size_t count, float* X, float* Y, float* Z) const
+{
+	generateXY(first, count, X, Y);
+	std::fill_n(Z, count, A0.getZ());
+}
+
+Matrix Disc::materialize() const
+{
+	Matrix M(3, colonnes());
+	float* X = M[0];
+	float* Y = M[1];
+	float* Z = M[2];
+	// Each thread fills a slab of points
+	MathLib::parallel_for(0, size(), MathLib::PARALLEL_GRAIN, [&](std::size_t first, std::size_t last)
+	{
+		generateXY(first, last - first, X + first, Y + first);
+		std::fill(Z + first, Z + last, A0.getZ());
+	});
+	return M;
+}
+
+FVector3 Disc::centroid() const
+{
+	// Every ring is symmetric around the center
+	return A0;
+}
+
+/**
+ * Mean of x^2 (and of y^2) around the center over the points of the disc
+ * For n >= 3, the sum of cos^2 over a ring is n / 2 and the sum of cos * sin is 0
+ * @return : R^2 (n + 1) (2n + 1) / (12 (n^2 + 1))
+ */
+double Disc::varianceRayon() const
+{
+	const double sommeR2 = static_cast<double>(R) * R * (n + 1.0) * (2.0 * n + 1.0) / (6.0 * n);
+	return 0.5 * n * sommeR2 / static_cast<double>(size());
+}
+
+Matrix Disc::inertiaAtCentroid(float m) const
+{
+	const double var = varianceRayon();
+	return inertieDiagonale(m, var, var, 0);
+}
+
+Cylinder::Cylinder(float R, float h, const FVector3& A0, int n, int s_h)
+	: R(R), h(std::max<float>(h, 1)), A0(A0), n(std::max(n, 3)), s_h(std::max(s_h, 2)),
+	  n_cercles(static_cast<int>(this->h * this->s_h)), disc(R, A0, n)
+{
+}
+
+std::size_t Cylinder::size() const
+{
+	return static_cast<std::size_t>(n_cercles) * disc.size();
+}
+
+void Cylinder::generate(std::size_t first, std::size_t count, float* X, float* Y, float* Z) const
+{
+	const std::size_t n_cercle = disc.size();
+	std::size_t index = first;
+	const std::size_t last = first + count;
+	while (index < last)
+	{
+		const std::size_t i = index / n_cercle;
+		const std::size_t j0 = index % n_cercle;
+		const std::size_t len = std::min(n_cercle - j0, last - index);
+		disc.generateXY(j0, len, X, Y);
+		// Height of the circle
+		std::fill_n(Z, len, A0.getZ() + static_cast<float>(i) / s_h);
+		X += len;
+		Y += len;
+		Z += len;
+		index += len;
+	}
+}
+
+Matrix Cylinder::materialize() const
+{
+	const std::size_t n_cercle = disc.size();
+	Matrix M(3, colonnes());
+	float* X = M[0];
+	float* Y = M[1];
+	float* Z = M[2];
+
+	// Every circle has the same X and Y coordinates: generate the first one, then only copy it
+	disc.generateXY(0, n_cercle, X, Y);
+	// Each thread fills a slab of circles
+	MathLib::parallel_for(0, n_cercles, std::max<std::size_t>(MathLib::PARALLEL_GRAIN / n_cercle, 1), [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; ++i)
+		{
+			const std::size_t offset = i * n_cercle;
+			if (i > 0)
+			{
+				std::copy_n(X, n_cercle, X + offset);
+				std::copy_n(Y, n_cercle, Y + offset);
+			}
+			// Height of the circle
+			std::fill_n(Z + offset, n_cercle, A0.getZ() + static_cast<float>(i) / s_h);
+		}
+	});
+	return M;
+}
+
+FVector3 Cylinder::centroid() const
+{
+	return { A0.getX(), A0.getY(), static_cast<float>(A0.getZ() + 0.5 * (n_cercles - 1) / s_h) };
+}
+
+Matrix Cylinder::inertiaAtCentroid(float m) const
+{
+	// Every slice is the same disc, the heights are evenly spaced by 1 / s_h
+	const double var = disc.varianceRayon();
+	return inertieDiagonale(m, var, var, varianceGrille(n_cercles, 1.0 / s_h));
+}
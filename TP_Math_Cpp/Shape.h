@@ -0,0 +1,143 @@
+#pragma once
+
+#include "FVector3.h"
+#include "Matrix.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Procedural description of a solid made of points
+ * Points are generated on demand, by index range, so a shape never has to be stored as a whole
+ */
+class Shape
+{
+public:
+	// Default number of points generated at once by forEachChunk
+	static constexpr std::size_t CHUNK_SIZE = 4096;
+
+	virtual ~Shape() = default;
+
+	// Number of points of the shape
+	virtual std::size_t size() const = 0;
+
+	/**
+	 * Generate the points [first, first + count[ of the shape
+	 * @param first : index of the first point
+	 * @param count : number of points to generate
+	 * @param X : Output X coordinates (count values)
+	 * @param Y : Output Y coordinates (count values)
+	 * @param Z : Output Z coordinates (count values)
+	 */
+	virtual void generate(std::size_t first, std::size_t count, float* X, float* Y, float* Z) const = 0;
+
+	// Build the full 3xN matrix of points
+	virtual Matrix materialize() const;
+
+	FVector3 point(std::size_t i) const;
+
+	// Center of inertia, streamed over the points unless the shape knows its closed form
+	virtual FVector3 centroid() const;
+	// Inertia matrix about the center of inertia for a total mass m
+	virtual Matrix inertiaAtCentroid(float m) const;
+	// Inertia matrix about the origin for a total mass m, same convention as MathLib::matrice_inert
+	Matrix inertia(float m) const;
+
+	/**
+	 * Stream the points through a buffer of at most chunk points
+	 * @param f : callable taking (const float* X, const float* Y, const float* Z, std::size_t count)
+	 * @param chunk : maximum number of points per call, at least 1
+	 */
+	template<class Function>
+	void forEachChunk(Function&& f, std::size_t chunk = CHUNK_SIZE) const
+	{
+		if (chunk == 0)
+			throw std::invalid_argument("The chunk size must be at least 1");
+		const std::size_t n = size();
+		chunk = std::min(chunk, n);
+		std::vector<float> buffer(3 * chunk);
+		float* X = buffer.data();
+		float* Y = X + chunk;
+		float* Z = Y + chunk;
+		for (std::size_t first = 0; first < n; first += chunk)
+		{
+			const std::size_t count = std::min(chunk, n - first);
+			generate(first, count, X, Y, Z);
+			f(static_cast<const float*>(X), static_cast<const float*>(Y), static_cast<const float*>(Z), count);
+		}
+	}
+
+protected:
+	int colonnes() const;
+};
+
+/**
+ * Box of nx * ny * nz points, same layout as MathLib::pave_plein
+ */
+class Box : public Shape
+{
+public:
+	Box(int nx, int ny, int nz, float a, float b, float c, const FVector3& A0);
+
+	std::size_t size() const override;
+	void generate(std::size_t first, std::size_t count, float* X, float* Y, float* Z) const override;
+	Matrix materialize() const override;
+	FVector3 centroid() const override;
+	Matrix inertiaAtCentroid(float m) const override;
+
+private:
+	int nx, ny, nz;
+	float a, b, c;
+	FVector3 A0;
+	float dx, dy, dz;
+};
+
+/**
+ * Disc of n rings of n points around its center, same layout as MathLib::cercle_plein
+ */
+class Disc : public Shape
+{
+public:
+	Disc(float R, const FVector3& A0, int n = 8);
+
+	std::size_t size() const override;
+	void generate(std::size_t first, std::size_t count, float* X, float* Y, float* Z) const override;
+	Matrix materialize() const override;
+	FVector3 centroid() const override;
+	Matrix inertiaAtCentroid(float m) const override;
+
+	// Write the X and Y coordinates of the points [first, first + count[ of the disc
+	void generateXY(std::size_t first, std::size_t count, float* X, float* Y) const;
+	double varianceRayon() const;
+
+private:
+	float R;
+	FVector3 A0;
+	int n;
+	// Unit ring, cos and sin of 2*pi*j/n
+	std::vector<double> cosT, sinT;
+};
+
+/**
+ * Stack of discs, same layout as MathLib::cylindre_plein
+ */
+class Cylinder : public Shape
+{
+public:
+	Cylinder(float R, float h, const FVector3& A0, int n = 8, int s_h = 6);
+
+	std::size_t size() const override;
+	void generate(std::size_t first, std::size_t count, float* X, float* Y, float* Z) const override;
+	Matrix materialize() const override;
+	FVector3 centroid() const override;
+	Matrix inertiaAtCentroid(float m) const override;
+
+private:
+	float R, h;
+	FVector3 A0;
+	int n, s_h;
+	int n_cercles;
+	Disc disc;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Bounded lock-free queue between exactly one producer thread and one consumer thread
+ * The slots are allocated once and filled in place: the producer reserves the next free slot, writes it and publishes it,
+ * the consumer reads the oldest published slot and releases it. Nothing is allocated or copied by the queue itself.
+ * Each side only writes its own index and keeps a cached copy of the other one, so the shared cache lines are only
+ * touched when the cached copy says the queue looks full (producer) or empty (consumer)
+ */
+template<class T>
+class SpscQueue
+{
+public:
+	/**
+	 * @param capacite : Number of slots, rounded up to a power of two
+	 * @param modele : Value every slot is initialized with, so the slots can own preallocated buffers
+	 */
+	explicit SpscQueue(std::size_t capacite, const T& modele = T())
+	{
+		if (capacite == 0)
+			throw std::invalid_argument("Queue needs a capacity of at least one slot");
+		std::size_t taille = 1;
+		while (taille < capacite)
+			taille *= 2;
+		slots.assign(taille, modele);
+		masque = taille - 1;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	std::size_t capacity() const { return slots.size(); }
+
+	// Producer side
+
+	/**
+	 * @return : The next free slot, to be filled then published, or nullptr when the queue is full
+	 */
+	T* reserver()
+	{
+		const std::size_t e = ecriture.load(std::memory_order_relaxed);
+		if (e - lectureCache == slots.size())
+		{
+			lectureCache = lecture.load(std::memory_order_acquire);
+			if (e - lectureCache == slots.size())
+				return nullptr;
+		}
+		return &slots[e & masque];
+	}
+
+	// Hand the slot returned by reserver to the consumer
+	void publier()
+	{
+		ecriture.store(ecriture.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// No slot will be published anymore, the consumer stops once the queue is drained
+	void fermer() { fermee.store(true, std::memory_order_release); }
+
+	// Consumer side
+
+	/**
+	 * @return : The oldest published slot, or nullptr when the queue is empty
+	 */
+	T* front()
+	{
+		const std::size_t l = lecture.load(std::memory_order_relaxed);
+		if (l == ecritureCache)
+		{
+			ecritureCache = ecriture.load(std::memory_order_acquire);
+			if (l == ecritureCache)
+				return nullptr;
+		}
+		return &slots[l & masque];
+	}
+
+	// Give the slot returned by front back to the producer
+	void liberer()
+	{
+		lecture.store(lecture.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/**
+	 * To be called by the consumer when front returned nullptr
+	 * @return : true when the producer closed the queue and every published slot was read
+	 */
+	bool terminee()
+	{
+		if (!fermee.load(std::memory_order_acquire))
+			return false;
+		// Slots published before the closing are visible now
+		return front() == nullptr;
+	}
+
+private:
+	// Written by the consumer, read by the producer
+	alignas(64) std::atomic<std::size_t> lecture{ 0 };
+	std::size_t ecritureCache = 0;  // Consumer's copy of ecriture
+	// Written by the producer, read by the consumer
+	alignas(64) std::atomic<std::size_t> ecriture{ 0 };
+	std::size_t lectureCache = 0;   // Producer's copy of lecture
+	alignas(64) std::atomic<bool> fermee{ false };
+
+	std::vector<T> slots;
+	std::size_t masque = 0;
+};
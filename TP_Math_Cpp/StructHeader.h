@@ -1,5 +1,6 @@
 #pragma once
 #include "FVector3.h"
+#include "Integrators.h"
 #include "Matrix.h"
 
 struct MovementResult
@@ -20,3 +21,13 @@ struct MovementResult
         std::cout << "newTetap: " << newTetap.ToString() << '\n';
     }
 };
+
+struct AdaptiveResult
+{
+    std::vector<float> temps;        // Requested output times
+    std::vector<MotionState> etats;  // State of the solid at each output time
+    std::vector<Matrix> snapshots;   // Solid matrix at each output time
+    int evaluations = 0;             // Number of force evaluations
+    int pasAcceptes = 0;             // Number of accepted steps
+    int pasRejetes = 0;              // Number of rejected steps
+};
@@ -1,9 +1,35 @@
 ﻿#include "Test.h"
 
 #include "MathLib.h"
+#include "Allocations.h"
+#include "BarnesHut.h"
+#include "Broadphase.h"
+#include "Ensemble.h"
+#include "ForceField.h"
+#include "FrameSink.h"
 #include "JsonConverter.h"
+#include "MassAccumulator.h"
+#include "Moments.h"
+#include "Parallel.h"
+#include "Pipeline.h"
+#include "RigidBody.h"
+#include "SceneGraph.h"
+#include "Shape.h"
+#include "ThreadPool.h"
+#include "Trajectory.h"
+#include "TrajectoryGenerator.h"
+#include "TransformPoints.h"
+#include "World.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
 
 #define FILE_PATH "../data.json"
 
@@ -143,6 +169,41 @@ void testFactorielSinusCosinus()
     std::cout << "sin(" << x << ") = " << MathLib::sinus(x, n) << " (vs std::sin(x) = " << std::sin(x) << ")\n";
 }
 
+void testConstexpr()
+{
+    // Everything below is evaluated by the compiler
+    static_assert(MathLib::factoriel(5) == 120, "factoriel(5)");
+    static_assert(MathLib::factoriel(MathLib::FACTORIEL_MAX) == 2432902008176640000ULL, "factoriel(20)");
+    static_assert(MathLib::truncate(3.14159265, 3) == 3.141, "truncate");
+    static_assert(MathLib::roundToPrecision(2.71828, 2) == 2.72, "roundToPrecision");
+    constexpr double c = MathLib::cosinus(0.5);
+    constexpr double s = MathLib::sinus(0.5);
+    static_assert(c * c + s * s > 0.9999999 && c * c + s * s < 1.0000001, "cos^2 + sin^2 = 1");
+    // Large angles are reduced to [-pi, pi] before the series
+    static_assert(MathLib::cosinus(30.0) > 0.15425 && MathLib::cosinus(30.0) < 0.15426, "cos(30)");
+    static_assert(MathLib::sinus(-20.0) > -0.91295 && MathLib::sinus(-20.0) < -0.91294, "sin(-20)");
+
+    constexpr FMatrix3 R = MathLib::matrice_rotation(FVector3(0.1f, 0.2f, 0.3f));
+    constexpr FMatrix3 RRt = R * FMatrix3::tran(R);
+    static_assert(RRt[0][0] > 0.9999f && RRt[0][0] < 1.0001f, "R * Rt = Id");
+
+    constexpr auto cercle = MathLib::cercle_plein_fixe<8>(1.f, FVector3(0.f, 0.f, 0.f));
+    constexpr auto pave = MathLib::pave_plein_fixe<3>(3.f, 3.f, 3.f, FVector3(0.f, 0.f, 0.f));
+
+    std::cout << "cos(0.5) = " << c << " (vs std::cos(0.5) = " << std::cos(0.5) << ")\n";
+    std::cout << "sin(0.5) = " << s << " (vs std::sin(0.5) = " << std::sin(0.5) << ")\n";
+    std::cout << "Rotation matrix :\n" << R.ToString();
+    MathLib::printMatrix(MathLib::toMatrix(pave), "Pave droit (compile time) :");
+
+    // Compare with the runtime generator
+    const Matrix runtime = MathLib::cercle_plein(1.f, FVector3(0.f, 0.f, 0.f));
+    float maxDiff = 0;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < runtime.getCols(); j++)
+            maxDiff = std::max(maxDiff, std::abs(runtime[i][j] - cercle[i][j]));
+    std::cout << "Max difference cercle_plein / cercle_plein_fixe : " << maxDiff << '\n';
+}
+
 void testCercle()
 {
     const FVector3 A0(0.f, 0.f, 0.f);
@@ -163,6 +224,126 @@ void testCylindre()
     MathLib::printMatrix(result, "Cylindre :");
 }
 
+void testGenerateurs()
+{
+    const FVector3 A0(0.f, 0.f, 0.f);
+    const auto start = std::chrono::steady_clock::now();
+    const Matrix pave = MathLib::pave_plein(400, 250, 100, 4.f, 2.5f, 1.f, A0);
+    const auto t1 = std::chrono::steady_clock::now();
+    const Matrix cylindre = MathLib::cylindre_plein(1.f, 50.f, A0, 200, 20);
+    const auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << "Threads : " << MathLib::nombreThreads() << '\n';
+    std::cout << "pave_plein 400x250x100 (" << pave.getCols() << " points) : "
+              << std::chrono::duration<double, std::milli>(t1 - start).count() << " ms\n";
+    std::cout << "cylindre_plein (" << cylindre.getCols() << " points) : "
+              << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+    std::cout << "Last point of the pave : " << pave[0][pave.getCols() - 1] << ", "
+              << pave[1][pave.getCols() - 1] << ", " << pave[2][pave.getCols() - 1] << '\n';
+}
+
+void testShape()
+{
+    // Small cylinder: streamed results against the materialized point cloud
+    const Cylinder petit(1.f, 4.f, FVector3(0.f, 0.f, 0.f));
+    const Matrix W = petit.materialize();
+    std::vector<FVector3> points;
+    for (int i = 0; i < W.getCols(); ++i)
+        points.emplace_back(W[0][i], W[1][i], W[2][i]);
+    std::cout << "G (points)   : " << MathLib::centre_inert(points).ToString() << '\n';
+    std::cout << "G (streamed) : " << MathLib::centre_inert(petit).ToString() << '\n';
+    MathLib::printMatrix(MathLib::matrice_inert(points, 10.f), "Inertia matrix (points) :");
+    MathLib::printMatrix(MathLib::matrice_inert(petit, 10.f), "Inertia matrix (streamed) :");
+
+    // Large cylinder: never materialized
+    const Cylinder grand(1.f, 100.f, FVector3(0.f, 0.f, 0.f), 1000, 10);
+    std::cout << "Points : " << grand.size() << '\n';
+    std::cout << "G : " << MathLib::centre_inert(grand).ToString() << '\n';
+
+    std::ofstream file(FILE_PATH);
+    JsonConverter::WriteShape(file, petit, MathLib::centre_inert(petit), FVector3(0.5f, 0.f, 0.f));
+    file.close();
+}
+
+void testInertieAnalytique()
+{
+    constexpr float m = 10.f;
+    const Box pave(7, 5, 3, 3.f, 2.f, 1.f, FVector3(1.f, -2.f, 0.5f));
+    const Disc disque(2.f, FVector3(-1.f, 1.f, 3.f), 12);
+    const Cylinder cylindre(1.f, 4.f, FVector3(0.5f, 0.f, -1.f));
+    const Shape* formes[] = { &pave, &disque, &cylindre };
+    const char* noms[] = { "Box", "Disc", "Cylinder" };
+
+    for (int f = 0; f < 3; ++f)
+    {
+        // Reference: reduction over the sampled point cloud
+        const Matrix W = formes[f]->materialize();
+        std::vector<FVector3> points;
+        for (int i = 0; i < W.getCols(); ++i)
+            points.emplace_back(W[0][i], W[1][i], W[2][i]);
+
+        std::cout << noms[f] << '\n';
+        std::cout << "G (points)     : " << MathLib::centre_inert(points).ToString() << '\n';
+        std::cout << "G (analytic)   : " << formes[f]->centroid().ToString() << '\n';
+        MathLib::printMatrix(MathLib::matrice_inert(points, m), "Inertia matrix (points) :");
+        MathLib::printMatrix(formes[f]->inertia(m), "Inertia matrix (analytic) :");
+    }
+}
+
+void testReductions()
+{
+    // Cloud far from the origin: float accumulation loses the small offsets
+    std::vector<FVector3> points;
+    points.reserve(4000000);
+    for (int i = 0; i < 4000000; ++i)
+        points.emplace_back(1000.f + (i % 1000) * 0.001f, -500.f + (i % 777) * 0.01f, 0.5f * (i % 3));
+
+    // Naive float accumulation for comparison
+    FVector3 naive = FVector3::Zero();
+    for (const auto& p : points)
+        naive += p;
+    naive = naive / static_cast<float>(points.size());
+
+    const auto start = std::chrono::steady_clock::now();
+    const FVector3 G = MathLib::centre_inert(points);
+    const Matrix I = MathLib::matrice_inert(points, 10.f);
+    const auto end = std::chrono::steady_clock::now();
+
+    std::cout << "G (float sum) : " << naive.ToString() << '\n';
+    std::cout << "G             : " << G.ToString() << " (expected X: 1000.5, Y: -496.12, Z: 0.5)\n";
+    MathLib::printMatrix(I, "Inertia matrix :");
+    std::cout << "centre_inert + matrice_inert on " << points.size() << " points : "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+}
+
+void testAccumulateur()
+{
+    constexpr float m = 10.f;
+    const Cylinder cylindre(1.f, 4.f, FVector3(0.f, 0.f, 0.f));
+    const Matrix W = cylindre.materialize();
+    std::vector<FVector3> corps, haut;
+    for (int i = 0; i < W.getCols(); ++i)
+        (W[2][i] < 3.f ? corps : haut).emplace_back(W[0][i], W[1][i], W[2][i]);
+    const float massePoint = m / static_cast<float>(W.getCols());
+
+    // Whole cylinder, then the top part is cut off
+    MassAccumulator acc;
+    acc.add(cylindre, m);
+    MassAccumulator accHaut;
+    accHaut.add(haut, massePoint * static_cast<float>(haut.size()));
+    acc.remove(accHaut);
+
+    std::cout << "Mass : " << acc.masse() << " (expected " << massePoint * static_cast<float>(corps.size()) << ")\n";
+    std::cout << "G (accumulator) : " << acc.centre().ToString() << '\n';
+    std::cout << "G (points)      : " << MathLib::centre_inert(corps).ToString() << '\n';
+    MathLib::printMatrix(acc.inertie(FVector3::Zero()), "Inertia matrix at the origin (accumulator) :");
+    MathLib::printMatrix(MathLib::matrice_inert(corps, acc.masse()), "Inertia matrix at the origin (points) :");
+
+    // A single point added on the side, inertia about an arbitrary point
+    acc.add(FVector3(2.f, 0.f, 1.f), 1.f);
+    MathLib::printMatrix(acc.inertie(FVector3(1.f, -1.f, 2.f)), "Inertia matrix at (1, -1, 2) with an extra point :");
+}
+
 void testMouvement()
 {
    // Paramètres du cylindre
@@ -225,3 +406,961 @@ void testMouvement()
     file << std::setfill(' ') << std::setw(2) << JsonConverter::MatrixToJson(results[3]);
     file.close();
 }
+
+void testStep()
+{
+    const Matrix cylindre = MathLib::cylindre_plein(1.f, 4.f, FVector3(0, 0, 0));
+    const Cylinder forme(1.f, 4.f, FVector3(0, 0, 0));
+    constexpr float m = 10.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertia(m);
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(50, 0, 0) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(1.f, 0.f, 3.8333f) } };
+    constexpr float h = 0.01f;
+    constexpr int n = 1000;
+
+    // Reference: MathLib::mouvement, copies everything at each step
+    auto start = std::chrono::steady_clock::now();
+    std::size_t avant = MathLib::allocations();
+    MovementResult result{ cylindre, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero() };
+    for (int i = 0; i < n; ++i)
+        result = MathLib::mouvement(result.newW, m, I, result.newG, result.newV, result.newTeta, result.newTetap, forces, points, h);
+    const double tempsMouvement = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const std::size_t allocMouvement = MathLib::allocations() - avant;
+
+    // In place: the first step sizes the scratch buffers, the following ones must not allocate
+    RigidBodyState etat(cylindre, m, I, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+    MathLib::step(etat, forces, points, h);
+    start = std::chrono::steady_clock::now();
+    avant = MathLib::allocations();
+    for (int i = 1; i < n; ++i)
+        MathLib::step(etat, forces, points, h);
+    const double tempsStep = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const std::size_t allocStep = MathLib::allocations() - avant;
+
+    float maxDiff = 0;
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < etat.W.getCols(); ++c)
+            maxDiff = std::max(maxDiff, std::abs(etat.W[r][c] - result.newW[r][c]));
+
+    // Cached body-frame inertia, the world-frame inverse follows the orientation
+    RigidBody corps(cylindre, m, I, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+    corps.step(forces, points, h);
+    start = std::chrono::steady_clock::now();
+    avant = MathLib::allocations();
+    for (int i = 1; i < n; ++i)
+        corps.step(forces, points, h);
+    const double tempsCorps = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const std::size_t allocCorps = MathLib::allocations() - avant;
+
+    // The allocations are only counted in a build defining MATHLIB_COMPTER_ALLOCATIONS, the Debug configurations
+    const auto compte = [](std::size_t allocations)
+    {
+        return MathLib::allocationsComptees() ? std::to_string(allocations) + " allocations" : std::string("allocations not counted");
+    };
+    std::cout << "mouvement       : " << tempsMouvement << " ms, " << compte(allocMouvement) << " for " << n << " steps\n";
+    std::cout << "step            : " << tempsStep << " ms, " << compte(allocStep) << " for " << n - 1 << " steps\n";
+    std::cout << "RigidBody::step : " << tempsCorps << " ms, " << compte(allocCorps) << " for " << n - 1 << " steps\n";
+    std::cout << "Angles : " << etat.teta.ToString() << '\n';
+    // The integrators turn the orientation by a rotation, their angles stay in [-pi, pi]
+    std::cout << "Angles (world-frame inertia) : " << corps.getState().teta.ToString() << '\n';
+    std::cout << "G : " << etat.G.ToString() << " (mouvement: " << result.newG.ToString() << ")\n";
+    std::cout << "Max difference between the solids : " << maxDiff << '\n';
+}
+
+void testIntegrateurs()
+{
+    const Box forme(3, 3, 3, 1.f, 1.f, 2.f, FVector3(0.f, 0.f, 0.f));
+    const Matrix W = forme.materialize();
+    constexpr float m = 2.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertiaAtCentroid(m);
+    // Gravity at G and a constant push on a fixed point: the torque changes as G moves
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(4.f, 1.f, 0.f) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(0.5f, 0.f, 2.f) } };
+    constexpr float T = 1.f;
+
+    const auto simule = [&](auto integrateur, int n)
+    {
+        RigidBody corps(W, m, I, G, FVector3(0.f, 1.f, 2.f), FVector3::Zero(), FVector3(0.f, 0.f, 1.f));
+        for (int i = 0; i < n; ++i)
+            corps.step<decltype(integrateur)>(forces, points, T / static_cast<float>(n));
+        return corps.getMotionState();
+    };
+    const auto norme = [](const FVector3& u) { return std::sqrt(u.getX() * u.getX() + u.getY() * u.getY() + u.getZ() * u.getZ()); };
+
+    const MotionState reference = simule(Integrators::RK4{}, 2000);
+    const auto erreur = [&](const MotionState& e) { return norme(e.G - reference.G) + norme(e.teta - reference.teta); };
+
+    std::cout << "Error on G + teta after " << T << " s\n";
+    std::cout << std::setw(8) << "steps" << std::setw(16) << "ExplicitEuler" << std::setw(18) << "SemiImplicitEuler"
+              << std::setw(16) << "VelocityVerlet" << std::setw(14) << "RK4" << '\n';
+    for (int n : { 10, 20, 50, 100, 200, 500, 1000 })
+    {
+        std::cout << std::setw(8) << n
+                  << std::setw(16) << erreur(simule(Integrators::ExplicitEuler{}, n))
+                  << std::setw(18) << erreur(simule(Integrators::SemiImplicitEuler{}, n))
+                  << std::setw(16) << erreur(simule(Integrators::VelocityVerlet{}, n))
+                  << std::setw(14) << erreur(simule(Integrators::RK4{}, n)) << '\n';
+    }
+}
+
+void testAdaptatif()
+{
+    const Box forme(3, 3, 3, 1.f, 1.f, 2.f, FVector3(0.f, 0.f, 0.f));
+    const Matrix W = forme.materialize();
+    constexpr float m = 2.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertiaAtCentroid(m);
+    const FVector3 v(0.f, 1.f, 2.f);
+    const FVector3 tetap(0.f, 0.f, 1.f);
+    // Gravity at G and a constant push on a fixed point: the torque grows as G falls away from it
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(4.f, 1.f, 0.f) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(0.5f, 0.f, 2.f) } };
+    const std::vector<float> temps = { 0.25f, 0.5f, 0.75f, 1.f };
+    constexpr float T = 1.f;
+
+    const auto norme = [](const FVector3& u) { return std::sqrt(u.getX() * u.getX() + u.getY() * u.getY() + u.getZ() * u.getZ()); };
+    const auto fixe = [&](int n)
+    {
+        RigidBody corps(W, m, I, G, v, FVector3::Zero(), tetap);
+        for (int i = 0; i < n; ++i)
+            corps.step<Integrators::RK4>(forces, points, T / static_cast<float>(n));
+        return corps.getMotionState();
+    };
+    const MotionState reference = fixe(2000);
+    const auto erreur = [&](const MotionState& e) { return norme(e.G - reference.G) + norme(e.teta - reference.teta); };
+
+    std::cout << "Adaptive Bogacki-Shampine, error on G + teta after " << T << " s\n";
+    std::cout << std::setw(10) << "tolerance" << std::setw(14) << "error" << std::setw(13) << "evaluations"
+              << std::setw(10) << "accepted" << std::setw(10) << "rejected" << '\n';
+    for (float tol : { 1e-2f, 1e-3f, 1e-4f, 1e-5f })
+    {
+        AdaptiveOptions options;
+        options.tolAbs = tol;
+        options.tolRel = tol;
+        const AdaptiveResult result = MathLib::trace_mouvements(W, m, I, G, v, FVector3::Zero(), tetap, forces, points, temps, options);
+        std::cout << std::setw(10) << tol << std::setw(14) << erreur(result.etats.back()) << std::setw(13) << result.evaluations
+                  << std::setw(10) << result.pasAcceptes << std::setw(10) << result.pasRejetes << '\n';
+    }
+
+    std::cout << "Fixed step RK4 (4 evaluations per step)\n";
+    std::cout << std::setw(10) << "steps" << std::setw(14) << "error" << std::setw(13) << "evaluations" << '\n';
+    for (int n : { 5, 10, 20, 50, 100 })
+        std::cout << std::setw(10) << n << std::setw(14) << erreur(fixe(n)) << std::setw(13) << 4 * n << '\n';
+
+    // The snapshots are the initial solid moved rigidly, not rotated again at every step
+    const AdaptiveResult result = MathLib::trace_mouvements(W, m, I, G, v, FVector3::Zero(), tetap, forces, points, temps);
+    const Matrix& dernier = result.snapshots.back();
+    std::cout << "Center of the last snapshot: "
+              << FVector3(dernier[0][13], dernier[1][13], dernier[2][13]).ToString() << " G: " << result.etats.back().G.ToString() << '\n';
+
+    // Initial angles of several turns: the snapshot must still be a rigid move of the solid
+    const AdaptiveResult tourne = MathLib::trace_mouvements(W, m, I, G, v, FVector3(20.f, -30.f, 40.f), tetap, forces, points, temps);
+    const Matrix& S = tourne.snapshots.back();
+    const auto distance = [&norme](const Matrix& M, int a, int b)
+    {
+        return norme(FVector3(M[0][a] - M[0][b], M[1][a] - M[1][b], M[2][a] - M[2][b]));
+    };
+    std::cout << "Distance between two points, initial / large angles: " << distance(W, 0, 26) << " / " << distance(S, 0, 26) << '\n';
+}
+
+void testGyroscopique()
+{
+    // Free box with three different moments of inertia, spun near its intermediate axis so it tumbles
+    const Box forme(3, 3, 3, 1.f, 2.f, 4.f, FVector3(0.f, 0.f, 0.f));
+    const Matrix W = forme.materialize();
+    constexpr float m = 2.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertiaAtCentroid(m);
+    const FVector3 tetap(0.05f, 4.f, 0.05f);
+    const std::vector<std::vector<FVector3>> forces;
+    const std::vector<std::vector<FVector3>> points;
+    // SemiImplicitEuler and RK4 have no gyroscopic term w x (I w): the speed stays constant and the box turns about a fixed
+    // axis, so their drift is rounding only (below 1e-5). ExponentialMap solves Euler's equations and the box tumbles,
+    // it drifts by about 1e-5 at h = 0.1 up to 1e-3 at h = 0.001, the float rounding of ten thousand Newton solves
+    constexpr float T = 10.f;
+
+    const auto norme = [](const FVector3& u) { return std::sqrt(u.getX() * u.getX() + u.getY() * u.getY() + u.getZ() * u.getZ()); };
+    const auto energie = [](const RigidBody& corps)
+    {
+        const FVector3& w = corps.getState().tetap;
+        const FVector3 Iw = corps.getState().I * w;
+        return 0.5f * (w.getX() * Iw.getX() + w.getY() * Iw.getY() + w.getZ() * Iw.getZ());
+    };
+    const auto moment = [&](const RigidBody& corps) { return norme(corps.getState().I * corps.getState().tetap); };
+
+    // Relative drift of the kinetic energy and of the angular momentum after T seconds
+    const auto derive = [&](auto integrateur, float h)
+    {
+        RigidBody corps(W, m, I, G, FVector3::Zero(), FVector3::Zero(), tetap);
+        const float E0 = energie(corps);
+        const float L0 = moment(corps);
+        const int n = static_cast<int>(T / h);
+        for (int i = 0; i < n; ++i)
+            corps.step<decltype(integrateur)>(forces, points, h);
+        std::ostringstream oss;
+        oss << std::setprecision(3) << (energie(corps) - E0) / E0 << " / " << (moment(corps) - L0) / L0;
+        return oss.str();
+    };
+
+    std::cout << "Drift of the energy / angular momentum of a tumbling box after " << T << " s\n";
+    std::cout << std::setw(8) << "h" << std::setw(24) << "SemiImplicitEuler" << std::setw(24) << "RK4"
+              << std::setw(24) << "ExponentialMap" << '\n';
+    for (float h : { 0.001f, 0.01f, 0.05f, 0.1f })
+    {
+        std::cout << std::setw(8) << h
+                  << std::setw(24) << derive(Integrators::SemiImplicitEuler{}, h)
+                  << std::setw(24) << derive(Integrators::RK4{}, h)
+                  << std::setw(24) << derive(Integrators::ExponentialMap{}, h) << '\n';
+    }
+}
+
+void testTrajectoire()
+{
+    // About 50k points moved over 10k steps: only the poses are kept
+    const Cylinder forme(1.f, 1.f, FVector3(0, 0, 0), 100, 5);
+    const Matrix W = forme.materialize();
+    constexpr float m = 10.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertia(m);
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(50, 0, 0) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(1.f, 0.f, 0.8f) } };
+    constexpr int n = 10000;
+
+    const auto start = std::chrono::steady_clock::now();
+    const Trajectory trajectoire = MathLib::trajectoire(W, m, I, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero(), forces, points, 0.0001f, n);
+    const auto t1 = std::chrono::steady_clock::now();
+    Matrix frame(3, W.getCols());
+    trajectoire.frame(n, frame);
+    const auto t2 = std::chrono::steady_clock::now();
+
+    const double poses = static_cast<double>(trajectoire.size() * sizeof(Pose)) / (1 << 20);
+    const double matrices = static_cast<double>(n) * 3 * W.getCols() * sizeof(float) / (1 << 20);
+    std::cout << W.getCols() << " points, " << n << " steps\n";
+    std::cout << "Poses : " << poses << " MB (vs " << matrices << " MB for every matrix), "
+              << std::chrono::duration<double, std::milli>(t1 - start).count() << " ms\n";
+    std::cout << "Last frame rebuilt in " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+
+    // The frame is the initial solid moved rigidly: same center, same distances between points
+    const auto norme = [](const FVector3& u) { return std::sqrt(u.getX() * u.getX() + u.getY() * u.getY() + u.getZ() * u.getZ()); };
+    const auto point = [](const Matrix& M, int i) { return FVector3(M[0][i], M[1][i], M[2][i]); };
+    const int dernier = W.getCols() - 1;
+    FVector3 centre = FVector3::Zero();
+    for (int i = 0; i < frame.getCols(); ++i)
+        centre += point(frame, i);
+    std::cout << "Center of the frame: " << (centre / static_cast<float>(frame.getCols())).ToString() << '\n';
+    std::cout << "Pose G: " << trajectoire[n].G.ToString() << ", teta: " << trajectoire[n].teta().ToString() << '\n';
+    std::cout << "Distance first / last point: " << norme(point(frame, 0) - point(frame, dernier))
+              << " (initially " << norme(point(W, 0) - point(W, dernier)) << ")\n";
+}
+
+void testSinks()
+{
+    const Cylinder forme(1.f, 4.f, FVector3(0, 0, 0));
+    const Matrix W = forme.materialize();
+    constexpr float m = 10.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertia(m);
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(50, 0, 0) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(1.f, 0.f, 3.8333f) } };
+
+    // 100k internal steps, one frame out of 1000 reaches the sinks: their memory does not depend on the duration
+    RingBufferSink derniers(5);
+    StatisticsSink statistiques;
+    FileSink fichier("../trajectoire.jsonl");
+    MultiSink sinks = { &derniers, &statistiques, &fichier };
+    RigidBody corps(Matrix(3, 0), m, I, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+    MathLib::simuler(corps, forces, points, 1e-5f, 100000, 1000, sinks);
+
+    std::cout << "Frames received: " << derniers.recus() << ", kept: " << derniers.size() << '\n';
+    for (std::size_t i = 0; i < derniers.size(); ++i)
+        std::cout << "  t = " << derniers[i].t << ", G: " << derniers[i].G.ToString() << '\n';
+    std::cout << "G between " << statistiques.getGMin().ToString() << " and " << statistiques.getGMax().ToString() << '\n';
+    std::cout << "Speed: mean " << statistiques.vitesseMoyenne() << ", deviation " << statistiques.vitesseEcartType()
+              << ", max " << statistiques.vitesseMax() << '\n';
+    std::cout << "Angular speed: mean " << statistiques.vitesseAngulaireMoyenne() << ", deviation "
+              << statistiques.vitesseAngulaireEcartType() << '\n';
+
+    // Frames at fixed times, with the points of the solid
+    RigidBody second(Matrix(3, 0), m, I, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+    FileSink instantanes("../instantanes.jsonl", W, G, FVector3::Zero());
+    RingBufferSink temps(4);
+    MultiSink sortie = { &instantanes, &temps };
+    MathLib::simuler(second, forces, points, 3e-4f, { 0.1f, 0.25f, 0.5f, 1.f }, sortie);
+    for (std::size_t i = 0; i < temps.size(); ++i)
+        std::cout << "t = " << temps[i].t << ", G: " << temps[i].G.ToString() << ", teta: " << temps[i].teta().ToString() << '\n';
+}
+
+void testGenerateurTrajectoire()
+{
+    const Cylinder forme(1.f, 4.f, FVector3(0, 0, 0));
+    constexpr float m = 10.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertia(m);
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(50, 0, 0) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(1.f, 0.f, 3.8333f) } };
+    const RigidBody corps(Matrix(3, 0), m, I, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+
+    // Unbounded simulation, stopped as soon as the center of gravity reaches the ground
+    TrajectoryGenerator generateur(corps, forces, points, 1e-4f, TrajectoryGenerator::SANS_FIN, 10);
+    for (const Pose& pose : generateur)
+    {
+        if (pose.G.getZ() <= 0)
+        {
+            std::cout << "Ground reached at t = " << pose.t << " after " << generateur.getEtapes() << " steps, G: "
+                      << pose.G.ToString() << '\n';
+            break;
+        }
+    }
+
+    // Simulation and analysis interleaved: only the frames that are asked for are computed
+    TrajectoryGenerator borne(corps, forces, points, 1e-3f, 1000, 100);
+    while (borne.suivant())
+        std::cout << "t = " << borne.courant().t << ", |v| = "
+                  << std::sqrt(borne.courant().v.getX() * borne.courant().v.getX() + borne.courant().v.getZ() * borne.courant().v.getZ())
+                  << '\n';
+    std::cout << "Steps done: " << borne.getEtapes() << '\n';
+
+    // A zero step would never reach the ground
+    try
+    {
+        TrajectoryGenerator immobile(corps, forces, points, 0.f);
+        std::cout << "Zero time step accepted\n";
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cout << "Caught: " << e.what() << '\n';
+    }
+}
+
+void testWorld()
+{
+    // Same update as mouvement for a single body
+    const Matrix I = { { 2, 0, 0 }, { 0, 3, 0 }, { 0, 0, 4 } };
+    const FVector3 F(1.f, 0.f, -9.81f);
+    const FVector3 A(0.5f, 0.2f, 1.f);
+    constexpr float m = 1.f;
+    constexpr float h = 0.01f;
+    Matrix W = { { 0 }, { 0 }, { 0 } };
+    FVector3 G(0, 0, 0), v(1, 0, 0), teta(0, 0, 0), tetap(0, 0, 0);
+    World monde;
+    const std::size_t corps = monde.ajouter(m, I, G, v, teta, tetap);
+    for (int i = 0; i < 100; ++i)
+    {
+        const MovementResult r = MathLib::mouvement(W, m, I, G, v, teta, tetap, { { F } }, { { A } }, h);
+        W = r.newW;
+        G = r.newG;
+        v = r.newV;
+        teta = r.newTeta;
+        tetap = r.newTetap;
+        monde.effacerForces();
+        monde.appliquerForce(corps, F, A);
+        monde.step(h);
+    }
+    std::cout << "mouvement G: " << G.ToString() << ", teta: " << teta.ToString() << '\n';
+    std::cout << "World     G: " << monde.getG(corps).ToString() << ", teta: " << monde.getTeta(corps).ToString() << '\n';
+
+    // Many bodies under gravity and a constant push
+    constexpr std::size_t n = 100000;
+    constexpr int steps = 100;
+    World foule;
+    foule.reserve(n);
+    foule.setGravite(FVector3(0, 0, -9.81f));
+    std::vector<RigidBodyState> etats;
+    etats.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const FVector3 Gi(static_cast<float>(i % 100), static_cast<float>(i / 100), 10.f);
+        foule.ajouter(m, I, Gi);
+        foule.appliquerForce(i, FVector3(0.5f, 0, 0), Gi + FVector3(0, 0, 1));
+        etats.emplace_back(Matrix(3, 0), m, I, Gi, FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; ++s)
+        foule.step(h);
+    const auto t1 = std::chrono::steady_clock::now();
+    const FMatrix3 I_inv = FMatrix3::inverse(FMatrix3::fromMatrix(I));
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const std::vector<std::vector<FVector3>> Fi = { { FVector3(0, 0, -9.81f * m), FVector3(0.5f, 0, 0) } };
+        const std::vector<std::vector<FVector3>> Ai = { { etats[i].G, etats[i].G + FVector3(0, 0, 1) } };
+        for (int s = 0; s < steps; ++s)
+            MathLib::step(etats[i], Fi, Ai, h, I_inv);
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << n << " bodies, " << steps << " steps, " << MathLib::nombreThreads() << " threads\n";
+    std::cout << "World : " << std::chrono::duration<double, std::milli>(t1 - start).count() << " ms\n";
+    std::cout << "MathLib::step per body : " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+    std::cout << "Last body G: " << foule.getG(n - 1).ToString() << " (vs " << etats[n - 1].G.ToString() << ")\n";
+}
+
+void testThreadPool()
+{
+    const Cylinder forme(1.f, 10.f, FVector3(0, 0, 0), 200, 50);
+    std::vector<FVector3> points;
+    forme.forEachChunk([&](const float* X, const float* Y, const float* Z, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            points.emplace_back(X[i], Y[i], Z[i]);
+    });
+
+    // The same results whatever the number of threads of the injected pool
+    for (unsigned int threads : { 1u, 2u, 3u, 8u })
+    {
+        ThreadPool pool(threads, ThreadPool::Affinite::Compacte);
+        MathLib::setThreadPool(&pool);
+        const auto start = std::chrono::steady_clock::now();
+        const Moments liste = MathLib::moments(points);
+        const Moments forme3D = MathLib::moments(forme);
+        const Matrix pave = MathLib::pave_plein(200, 200, 100, 1.f, 1.f, 1.f, FVector3(0, 0, 0));
+        const auto t1 = std::chrono::steady_clock::now();
+
+        // Nested loops share the pool instead of starting new threads
+        std::atomic<std::size_t> total{ 0 };
+        MathLib::parallel_for(0, 64, 1, [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; ++i)
+                MathLib::parallel_for(0, 1000, 10, [&](std::size_t a, std::size_t b) { total += b - a; });
+        });
+
+        std::cout << std::setw(2) << threads << " threads: " << std::chrono::duration<double, std::milli>(t1 - start).count()
+                  << " ms, sxx " << std::setprecision(17) << liste.sxx << " / " << forme3D.sxx << std::setprecision(6)
+                  << ", box " << pave.getCols() << " points, nested " << total << '\n';
+    }
+    MathLib::setThreadPool(nullptr);
+
+    // Exceptions thrown by a task reach the caller
+    try
+    {
+        MathLib::parallel_for(0, 1 << 20, 1024, [](std::size_t first, std::size_t) {
+            if (first == 0)
+                throw std::runtime_error("task failed");
+        });
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << "Caught: " << e.what() << '\n';
+    }
+
+    const double somme = MathLib::parallel_reduce(0, 1000000, 4096, 0.0,
+        [](std::size_t first, std::size_t last) { double s = 0; for (std::size_t i = first; i < last; ++i) s += 1.0 / (1.0 + i); return s; },
+        [](double a, double b) { return a + b; });
+    std::cout << "parallel_reduce harmonic sum: " << std::setprecision(17) << somme << std::setprecision(6) << '\n';
+}
+
+void testEnsemble()
+{
+    const Cylinder forme(1.f, 4.f, FVector3(0, 0, 0));
+    const FVector3 G = forme.centroid();
+    const Matrix I0 = forme.inertiaAtCentroid(1.f);
+    const std::vector<float> temps = { 0.25f, 0.5f, 0.75f, 1.f };
+
+    // Mass within 5 %, push within 10 %, initial speed with a 0.1 m/s noise
+    const auto generateur = [&](std::size_t, std::mt19937_64& rng)
+    {
+        std::uniform_real_distribution<float> masse(9.5f, 10.5f);
+        std::uniform_real_distribution<float> pousse(45.f, 55.f);
+        std::normal_distribution<float> bruit(0.f, 0.1f);
+        const float m = masse(rng);
+        EnsembleMembre p{ m, I0 * m, G, FVector3(bruit(rng), bruit(rng), bruit(rng)), FVector3::Zero(), FVector3::Zero(), {}, {} };
+        p.F = { { FVector3(0, 0, -9.81f * m) }, { FVector3(pousse(rng), 0, 0) } };
+        p.A = { { G }, { FVector3(1.f, 0.f, 3.8333f) } };
+        return p;
+    };
+
+    constexpr std::size_t membres = 2000;
+    const auto start = std::chrono::steady_clock::now();
+    const EnsembleStatistiques statistiques = MathLib::ensemble(membres, 42, generateur, 1e-3f, temps);
+    const auto t1 = std::chrono::steady_clock::now();
+    std::cout << membres << " members in " << std::chrono::duration<double, std::milli>(t1 - start).count() << " ms\n";
+    std::cout << std::setw(6) << "t" << std::setw(12) << "mean Gx" << std::setw(12) << "std Gx" << std::setw(12) << "min Gz"
+              << std::setw(12) << "max Gz" << std::setw(14) << "mean rotY" << std::setw(12) << "std rotY" << '\n';
+    for (std::size_t t = 0; t < temps.size(); ++t)
+    {
+        std::cout << std::setw(6) << statistiques.temps[t]
+                  << std::setw(12) << statistiques.G(t, 0).moyenne << std::setw(12) << statistiques.G(t, 0).ecartType()
+                  << std::setw(12) << statistiques.G(t, 2).min << std::setw(12) << statistiques.G(t, 2).max
+                  << std::setw(14) << statistiques.rotation(t, 1).moyenne << std::setw(12) << statistiques.rotation(t, 1).ecartType() << '\n';
+    }
+
+    std::cout << "Mean orientation at t = 1, rotation vector: " << statistiques.orientationMoyenne(temps.size() - 1).log().ToString() << '\n';
+
+    // Same seed, other number of threads: same statistics to the bit, with the members spread over the pool
+    std::mutex verrou;
+    std::set<std::thread::id> threads;
+    const auto generateurSuivi = [&](std::size_t i, std::mt19937_64& rng)
+    {
+        {
+            std::lock_guard<std::mutex> lock(verrou);
+            threads.insert(std::this_thread::get_id());
+        }
+        return generateur(i, rng);
+    };
+    ThreadPool pool(5);
+    MathLib::setThreadPool(&pool);
+    const EnsembleStatistiques autre = MathLib::ensemble(membres, 42, generateurSuivi, 1e-3f, temps);
+    MathLib::setThreadPool(nullptr);
+    std::cout << "Members run on " << threads.size() << " threads\n";
+    std::cout << "Identical with 5 threads: " << std::boolalpha
+              << (threads.size() > 1 && autre.G(3, 0).moyenne == statistiques.G(3, 0).moyenne
+                  && autre.rotation(3, 1).m2 == statistiques.rotation(3, 1).m2) << '\n';
+}
+
+void testPipeline()
+{
+    const Cylinder forme(1.f, 4.f, FVector3(0, 0, 0));
+    const Matrix W = forme.materialize();
+    constexpr float m = 10.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertia(m);
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(50, 0, 0) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(1.f, 0.f, 3.8333f) } };
+
+    // Same frames written by one thread, then by the three stages of the pipeline
+    const auto ecrire = [&](FrameSink& sink)
+    {
+        RigidBody corps(Matrix(3, 0), m, I, G, FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+        const auto start = std::chrono::steady_clock::now();
+        MathLib::simuler(corps, forces, points, 1e-4f, 20000, 20, sink);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    FileSink sequentiel("../sequentiel.jsonl", W, G, FVector3::Zero());
+    const double tSequentiel = ecrire(sequentiel);
+    PipelineSink pipeline("../pipeline.jsonl", W, G, FVector3::Zero(), 32);
+    const double tPipeline = ecrire(pipeline);
+    std::cout << "1000 frames of " << W.getCols() << " points, one thread: " << tSequentiel << " ms, pipeline: " << tPipeline << " ms\n";
+
+    const auto lire = [](const char* chemin)
+    {
+        std::ifstream file(chemin);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    std::cout << "Same file: " << std::boolalpha << (lire("../sequentiel.jsonl") == lire("../pipeline.jsonl")) << '\n';
+
+    // Lock-free queue between two threads, in order and without loss
+    SpscQueue<int> queue(16);
+    long long somme = 0;
+    bool ordre = true;
+    std::thread consommateur([&]()
+    {
+        int attendu = 0;
+        while (true)
+        {
+            const int* valeur = queue.front();
+            if (!valeur)
+            {
+                if (queue.terminee())
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+            ordre = ordre && *valeur == attendu++;
+            somme += *valeur;
+            queue.liberer();
+        }
+    });
+    for (int i = 0; i < 100000; ++i)
+    {
+        int* slot;
+        while (!(slot = queue.reserver()))
+            std::this_thread::yield();
+        *slot = i;
+        queue.publier();
+    }
+    queue.fermer();
+    consommateur.join();
+    std::cout << "Queue: sum " << somme << " (expected " << 99999LL * 100000 / 2 << "), in order: " << ordre << '\n';
+}
+
+void testTransformation()
+{
+    // One million points
+    const Matrix W = MathLib::pave_plein(100, 100, 100, 2.f, 1.f, 3.f, FVector3(-1, -0.5f, -1.5f));
+    const int n = W.getCols();
+    const FVector3 G(0.1f, 0.2f, 0.3f);
+    const FVector3 t(1.f, -2.f, 0.5f);
+    const FMatrix3 R = MathLib::matrice_rotation(FVector3(0.3f, -0.7f, 1.1f));
+    std::cout << "Kernel: " << MathLib::jeuInstructions() << ", " << MathLib::nombreThreads() << " threads\n";
+
+    // Previous point loop: one FVector3 per column
+    Matrix reference = W;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        const FVector3 P = R * (FVector3(reference[0][i], reference[1][i], reference[2][i]) - G) + G + t;
+        reference[0][i] = P.getX();
+        reference[1][i] = P.getY();
+        reference[2][i] = P.getZ();
+    }
+    const double tBoucle = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    Matrix resultat = W;
+    MathLib::transforme_points(resultat, R, G, t);
+    constexpr int repetitions = 20;
+    Matrix bench = W;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+        MathLib::transforme_points(bench, R, G, t);
+    const double tKernel = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repetitions;
+    // 12 bytes read and 12 bytes written per point
+    std::cout << n << " points, loop: " << tBoucle << " ms, kernel: " << tKernel << " ms ("
+              << 24.0 * n / (tKernel * 1e6) << " GB/s)\n";
+
+    float ecart = 0;
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < n; i++)
+            ecart = std::max(ecart, std::abs(resultat[r][i] - reference[r][i]));
+    std::cout << "Largest difference with the loop: " << ecart << '\n';
+
+    // The result of a point does not depend on how the points are split between threads
+    ThreadPool pool(3);
+    MathLib::setThreadPool(&pool);
+    Matrix autre = W;
+    MathLib::transforme_points(autre, R, G, t);
+    MathLib::setThreadPool(nullptr);
+    bool identique = true;
+    for (int r = 0; r < 3; r++)
+        identique = identique && std::equal(autre[r], autre[r] + n, resultat[r]);
+    std::cout << "Identical with 3 threads: " << std::boolalpha << identique << '\n';
+}
+
+void testTransform()
+{
+    const Matrix W = MathLib::pave_plein(100, 100, 100, 2.f, 1.f, 3.f, FVector3(-1, -0.5f, -1.5f));
+    const int n = W.getCols();
+    const FVector3 G(0.1f, 0.2f, 0.3f);
+    const FMatrix3 R = MathLib::matrice_rotation(FVector3(0.01f, -0.02f, 0.03f));
+    const FVector3 t(0.05f, 0.f, -0.02f);
+    constexpr int mouvements = 50;
+
+    // Each move rewrites the points
+    Matrix immediat = W;
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < mouvements; k++)
+        MathLib::transforme_points(immediat, R, G, t);
+    const double tImmediat = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // The moves are composed, the points are moved once
+    Matrix compose = W;
+    start = std::chrono::steady_clock::now();
+    Transform total;
+    for (int k = 0; k < mouvements; k++)
+        total = Transform::translation(t) * Transform::rotation(R, G) * total;
+    total.appliquer(compose, compose);
+    const double tCompose = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    float ecart = 0;
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < n; i++)
+            ecart = std::max(ecart, std::abs(immediat[r][i] - compose[r][i]));
+    std::cout << mouvements << " moves of " << n << " points, one pass per move: " << tImmediat << " ms, composed: " << tCompose
+              << " ms, largest difference: " << ecart << '\n';
+
+    // Inverse and homogeneous matrix
+    const Transform A = Transform(MathLib::matrice_rotation(FVector3(0.4f, 1.2f, -0.3f)), FVector3(1, 2, 3), 2.5f);
+    const FVector3 P(0.7f, -1.f, 2.f);
+    std::cout << "A^-1 * A * P: " << (A.inverse() * A * P).ToString() << ", P: " << P.ToString() << '\n';
+    const Matrix H = A.matrice() * Matrix{ { P.getX() }, { P.getY() }, { P.getZ() }, { 1 } };
+    std::cout << "4x4 matrix * P: " << H[0][0] << ", " << H[1][0] << ", " << H[2][0] << ", A * P: " << (A * P).ToString() << '\n';
+
+    // Arm with a wheel on the side: only the moved subtree is recomputed
+    SceneGraph scene;
+    const std::size_t base = scene.ajouter(Transform::translation(FVector3(0, 0, 1)));
+    const std::size_t epaule = scene.ajouter(Transform::translation(FVector3(0, 0, 2)), base);
+    const std::size_t coude = scene.ajouter(Transform::translation(FVector3(1, 0, 0)), epaule);
+    const std::size_t main = scene.ajouter(Transform::translation(FVector3(1, 0, 0)), coude);
+    scene.ajouter(Transform::translation(FVector3(0, 1, 0)), base);
+    scene.mettreAJour();
+    const std::size_t avant = scene.getRecalculs();
+    for (int k = 1; k <= 100; k++)
+    {
+        const FMatrix3 pli = MathLib::matrice_rotation(FVector3(0, 0, static_cast<float>(M_PI) / 200 * k));
+        scene.setLocal(coude, Transform::translation(FVector3(1, 0, 0)) * Transform::rotation(pli));
+        scene.getMonde(main);
+    }
+    std::cout << "Hand at " << scene.getMonde(main).getTranslation().ToString() << " after bending the elbow by pi / 2, "
+              << scene.getRecalculs() - avant << " world transforms recomputed over 100 updates of " << scene.size() << " nodes" << '\n';
+}
+
+void testInterpolation()
+{
+    const Cylinder forme(1.f, 4.f, FVector3(0, 0, 0));
+    const Matrix W = forme.materialize();
+    constexpr float m = 10.f;
+    const FVector3 G = forme.centroid();
+    const Matrix I = forme.inertia(m);
+    const std::vector<std::vector<FVector3>> forces = { { FVector3(0, 0, -9.81f * m) }, { FVector3(50, 0, 0) } };
+    const std::vector<std::vector<FVector3>> points = { { G }, { FVector3(1.f, 0.f, 3.8333f) } };
+    const FVector3 tetap(0.5f, 0.f, 1.f);
+    constexpr float h = 1e-4f;
+
+    // Reference: every millisecond of a 1 s motion, keyframes: same motion with fewer frames kept
+    const Trajectory reference = MathLib::trajectoire(W, m, I, G, FVector3::Zero(), FVector3::Zero(), tetap, forces, points, h, 10000, 10);
+    std::cout << std::setw(10) << "keys (ms)" << std::setw(14) << "slerp G" << std::setw(14) << "slerp angle"
+              << std::setw(14) << "squad G" << std::setw(14) << "squad angle" << '\n';
+    for (const int pas : { 800, 400, 200, 100 })
+    {
+        const Trajectory cles = MathLib::trajectoire(W, m, I, G, FVector3::Zero(), FVector3::Zero(), tetap, forces, points, h, 10000, pas);
+        const EcartInterpolation slerp = cles.ecart(reference, Interpolation::Slerp);
+        const EcartInterpolation squad = cles.ecart(reference, Interpolation::Squad);
+        std::cout << std::setw(10) << pas * h * 1000 << std::setw(14) << slerp.position << std::setw(14) << slerp.angle
+                  << std::setw(14) << squad.position << std::setw(14) << squad.angle << '\n';
+    }
+
+    // 60 fps playback from keys every 40 ms
+    const Trajectory cles = MathLib::trajectoire(W, m, I, G, FVector3::Zero(), FVector3::Zero(), tetap, forces, points, h, 10000, 400);
+    Matrix image(3, W.getCols());
+    const auto start = std::chrono::steady_clock::now();
+    int images = 0;
+    for (float t = 0; t <= 1.f; t = static_cast<float>(++images) / 60)
+        cles.echantillon(t, image);
+    const double duree = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << images << " frames at 60 fps from " << cles.size() << " keys in " << duree << " ms, G at t = 0.5: "
+              << cles.pose(0.5f).G.ToString() << ", simulated: " << reference[500].G.ToString() << '\n';
+}
+
+void testChampsDeForce()
+{
+    // One million points spinning about Z
+    const Matrix W = MathLib::pave_plein(100, 100, 100, 2.f, 1.f, 3.f, FVector3(-1, -0.5f, -1.5f));
+    const int n = W.getCols();
+    constexpr float m = 10.f;
+    const FVector3 G(0.1f, 0.2f, 0.3f);
+    const FVector3 v(1.f, 0.f, 0.f);
+    const FVector3 omega(0.f, 0.f, 2.f);
+    const GravityField gravite(FVector3(0, 0, -9.81f));
+    const DragField trainee(0.5f);
+    const RadialField puits(FVector3(5.f, 0.f, 0.f), -20.f);
+    const std::vector<const ForceField*> champs = { &gravite, &trainee, &puits };
+
+    const auto start = std::chrono::steady_clock::now();
+    const DoubleVector3 charge = MathLib::force_et_moment(W, G, v, omega, m, champs);
+    const double duree = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "3 fields on " << n << " points in " << duree << " ms, force: " << charge.v1.ToString()
+              << ", torque: " << charge.v2.ToString() << '\n';
+
+    // Same sums point by point, one FVector3 at a time
+    double F[3] = {}, M[3] = {};
+    const double masse = static_cast<double>(m) / n;
+    for (int i = 0; i < n; i++)
+    {
+        const double r[3] = { W[0][i] - G.getX(), W[1][i] - G.getY(), W[2][i] - G.getZ() };
+        const double vi[3] = { v.getX() - omega.getZ() * r[1], v.getY() + omega.getZ() * r[0], v.getZ() };
+        const double d[3] = { W[0][i] - 5.0, W[1][i], W[2][i] };
+        const double r2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + 1e-6;
+        const double puissance = -20.0 * masse / (r2 * std::sqrt(r2));
+        const double f[3] = { -0.5 * vi[0] + puissance * d[0], -0.5 * vi[1] + puissance * d[1], -9.81 * masse - 0.5 * vi[2] + puissance * d[2] };
+        F[0] += f[0];
+        F[1] += f[1];
+        F[2] += f[2];
+        M[0] += r[1] * f[2] - r[2] * f[1];
+        M[1] += r[2] * f[0] - r[0] * f[2];
+        M[2] += r[0] * f[1] - r[1] * f[0];
+    }
+    std::cout << "Point by point in double, force: " << F[0] << ", " << F[1] << ", " << F[2] << ", torque: " << M[0] << ", "
+              << M[1] << ", " << M[2] << '\n';
+
+    ThreadPool pool(3);
+    MathLib::setThreadPool(&pool);
+    const DoubleVector3 autre = MathLib::force_et_moment(W, G, v, omega, m, champs);
+    MathLib::setThreadPool(nullptr);
+    std::cout << "Identical with 3 threads: " << std::boolalpha
+              << (autre.v1.getX() == charge.v1.getX() && autre.v2.getZ() == charge.v2.getZ()) << '\n';
+
+    // Falling cylinder in a viscous fluid: the speed tends to m g / (k N), the spin decays
+    const Cylinder forme(1.f, 4.f, FVector3(0, 0, 0));
+    const Matrix points = forme.materialize();
+    const DragField fluide(0.01f);
+    RigidBody corps(points, m, forme.inertia(m), forme.centroid(), FVector3::Zero(), FVector3::Zero(), FVector3(0, 0, 3.f));
+    corps.setChamps({ &gravite, &fluide });
+    for (int i = 0; i < 2000; i++)
+        corps.step<Integrators::RK4>({}, {}, 5e-3f);
+    std::cout << "After 10 s, speed: " << corps.getState().v.ToString() << " (limit " << -m * 9.81f / (0.01f * points.getCols())
+              << "), angular speed: " << corps.getState().tetap.ToString() << '\n';
+
+    // A solid without points has nothing for the fields to act on
+    RigidBody cinematique(Matrix(3, 0), m, forme.inertia(m), forme.centroid(), FVector3::Zero(), FVector3::Zero(), FVector3::Zero());
+    try
+    {
+        cinematique.setChamps({ &gravite });
+        std::cout << "Fields accepted on a solid without points\n";
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cout << "Caught: " << e.what() << '\n';
+    }
+}
+
+void testBarnesHut()
+{
+    // Cluster of bodies, denser at the center, in units where the gravitational constant is 1
+    constexpr std::size_t n = 20000;
+    std::vector<float> X(n), Y(n), Z(n), masses(n);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> normale(0.f, 1.f);
+    std::uniform_real_distribution<float> uniforme(0.5f, 1.5f);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const float rayon = std::pow(uniforme(rng) - 0.5f, 2.f) * 10.f;
+        const float dx = normale(rng), dy = normale(rng), dz = normale(rng);
+        const float echelle = rayon / std::max(std::sqrt(dx * dx + dy * dy + dz * dz), 1e-6f);
+        X[i] = dx * echelle;
+        Y[i] = dy * echelle;
+        Z[i] = dz * echelle;
+        masses[i] = uniforme(rng) / n;
+    }
+
+    std::vector<float> DX(n), DY(n), DZ(n);
+    auto start = std::chrono::steady_clock::now();
+    BarnesHut::forcesDirectes(X.data(), Y.data(), Z.data(), masses.data(), n, DX.data(), DY.data(), DZ.data(), 1.f, 0.01f);
+    const double direct = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << n << " bodies, every pair in " << direct << " ms\n";
+
+    // Error of the tree against the direct sum, relative to the mean force
+    BarnesHut arbre(0.5f, 0.01f);
+    std::vector<float> FX(n), FY(n), FZ(n);
+    double moyenne = 0;
+    for (std::size_t i = 0; i < n; i++)
+        moyenne += std::sqrt(DX[i] * DX[i] + DY[i] * DY[i] + DZ[i] * DZ[i]) / n;
+    for (float theta : { 0.f, 0.3f, 0.5f, 0.8f })
+    {
+        arbre.setTheta(theta);
+        std::fill(FX.begin(), FX.end(), 0.f);
+        std::fill(FY.begin(), FY.end(), 0.f);
+        std::fill(FZ.begin(), FZ.end(), 0.f);
+        start = std::chrono::steady_clock::now();
+        arbre.construire(X.data(), Y.data(), Z.data(), masses.data(), n);
+        const double construction = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        arbre.forces(FX.data(), FY.data(), FZ.data(), 1.f);
+        const double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        double erreur = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double ex = FX[i] - DX[i], ey = FY[i] - DY[i], ez = FZ[i] - DZ[i];
+            erreur += std::sqrt(ex * ex + ey * ey + ez * ez) / n;
+        }
+        std::cout << "theta " << theta << ": " << arbre.getNoeuds() << " cells built in " << construction << " ms, forces in "
+                  << total << " ms, mean error " << erreur / moyenne * 100 << " %\n";
+    }
+
+    ThreadPool pool(3);
+    MathLib::setThreadPool(&pool);
+    std::vector<float> AX(n), AY(n), AZ(n);
+    arbre.construire(X.data(), Y.data(), Z.data(), masses.data(), n);
+    arbre.forces(AX.data(), AY.data(), AZ.data(), 1.f);
+    MathLib::setThreadPool(nullptr);
+    std::cout << "Identical with 3 threads: " << std::boolalpha << (AX == FX && AY == FY && AZ == FZ) << '\n';
+
+    // Two bodies in circular orbit around their center of mass, stepped by the world
+    World monde;
+    const Matrix I = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+    monde.ajouter(1.f, I, FVector3(-0.5f, 0.f, 0.f), FVector3(0.f, -std::sqrt(0.5f), 0.f));
+    monde.ajouter(1.f, I, FVector3(0.5f, 0.f, 0.f), FVector3(0.f, std::sqrt(0.5f), 0.f));
+    BarnesHut paire(0.5f, 0.f);
+    constexpr float h = 1e-3f;
+    const int pas = static_cast<int>(2 * 3.14159265f * std::sqrt(0.5f) / h);
+    for (int i = 0; i < pas; i++)
+    {
+        monde.effacerForces();
+        monde.appliquerGravitation(paire, 1.f);
+        monde.step(h);
+    }
+    std::cout << "After one period: " << monde.getG(0).ToString() << " and " << monde.getG(1).ToString()
+              << " (started at (-0.5, 0, 0) and (0.5, 0, 0))\n";
+}
+
+void testBroadphase()
+{
+    // Box of a rotated block: the OBB finds the sides of the block back, its AABB follows any orientation
+    const FVector3 G(1.f, 2.f, 3.f);
+    Matrix W = MathLib::pave_plein(20, 10, 40, 2.f, 1.f, 4.f, FVector3(0.f, 1.5f, 1.f));
+    const FMatrix3 R0 = MathLib::matrice_rotation(FVector3(0.3f, -0.7f, 1.1f));
+    MathLib::transforme_points(W, R0, G);
+    const OBB obb = OBB::principal(W);
+    std::cout << "OBB half sides: " << obb.demiCotes.ToString() << " (block of 2 x 1 x 4)\n";
+    const FMatrix3 R = MathLib::matrice_rotation(FVector3(-1.f, 0.4f, 2.f));
+    const FVector3 D(5.f, 0.f, -2.f);
+    const AABB predite = obb.aabb(R, G, D);
+    Matrix deplace = W;
+    MathLib::transforme_points(deplace, R, G, D - G);
+    const AABB exacte = AABB::englobant(deplace);
+    std::cout << "AABB of the points: (" << exacte.min[0] << ", " << exacte.min[1] << ", " << exacte.min[2] << ") - ("
+              << exacte.max[0] << ", " << exacte.max[1] << ", " << exacte.max[2] << "), from the OBB: (" << predite.min[0]
+              << ", " << predite.min[1] << ", " << predite.min[2] << ") - (" << predite.max[0] << ", " << predite.max[1]
+              << ", " << predite.max[2] << ")\n";
+
+    // Many bodies of the same size drifting in a box
+    constexpr std::size_t n = 20000;
+    constexpr float taille = 0.5f;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(0.f, 60.f);
+    std::uniform_real_distribution<float> vitesse(-1.f, 1.f);
+    std::vector<FVector3> P(n), V(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        P[i] = FVector3(position(rng), position(rng), position(rng));
+        V[i] = FVector3(vitesse(rng), vitesse(rng), vitesse(rng));
+    }
+    std::vector<AABB> boites(n);
+    const auto placer = [&]()
+    {
+        for (std::size_t i = 0; i < n; i++)
+            boites[i] = { { P[i].getX(), P[i].getY(), P[i].getZ() },
+                          { P[i].getX() + taille, P[i].getY() + taille, P[i].getZ() + taille } };
+    };
+    // Every pair, sorted along X to stay affordable
+    const auto naif = [&]()
+    {
+        std::vector<std::uint32_t> ordre(n);
+        for (std::uint32_t i = 0; i < n; i++)
+            ordre[i] = i;
+        std::sort(ordre.begin(), ordre.end(), [&](std::uint32_t a, std::uint32_t b) { return boites[a].min[0] < boites[b].min[0]; });
+        std::vector<PaireCandidate> paires;
+        for (std::size_t a = 0; a < n; a++)
+            for (std::size_t b = a + 1; b < n && boites[ordre[b]].min[0] <= boites[ordre[a]].max[0]; b++)
+                if (boites[ordre[a]].chevauche(boites[ordre[b]]))
+                    paires.emplace_back(std::min(ordre[a], ordre[b]), std::max(ordre[a], ordre[b]));
+        std::sort(paires.begin(), paires.end());
+        return paires;
+    };
+
+    SweepAndPrune sap;
+    const UniformGrid grille(taille);
+    bool identiques = true;
+    double tempsSap = 0, tempsGrille = 0;
+    std::size_t echanges = 0;
+    placer();
+    auto start = std::chrono::steady_clock::now();
+    sap.mettreAJour(boites);
+    const double construction = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    constexpr int pas = 20;
+    for (int k = 0; k < pas; k++)
+    {
+        for (std::size_t i = 0; i < n; i++)
+            P[i] += V[i] * 0.02f;
+        placer();
+        start = std::chrono::steady_clock::now();
+        sap.mettreAJour(boites);
+        tempsSap += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        echanges += sap.getEchanges();
+        start = std::chrono::steady_clock::now();
+        const std::vector<PaireCandidate> parGrille = grille.paires(boites);
+        tempsGrille += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const std::vector<PaireCandidate> reference = naif();
+        identiques = identiques && sap.getPaires() == reference && parGrille == reference;
+    }
+    std::cout << n << " bodies, " << sap.getNombrePaires() << " overlapping pairs, same as every pair over " << pas << " steps: "
+              << std::boolalpha << identiques << '\n';
+    std::cout << "Sweep and prune: first sort in " << construction << " ms, then " << tempsSap / pas << " ms and "
+              << echanges / pas << " swaps per step; uniform grid: " << tempsGrille / pas << " ms per step\n";
+
+    ThreadPool pool(3);
+    MathLib::setThreadPool(&pool);
+    SweepAndPrune autre;
+    autre.mettreAJour(boites);
+    const bool memes = autre.getPaires() == sap.getPaires() && grille.paires(boites) == sap.getPaires();
+    MathLib::setThreadPool(nullptr);
+    std::cout << "Identical with 3 threads: " << memes << '\n';
+}
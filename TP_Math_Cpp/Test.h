@@ -5,8 +5,31 @@ void testInversedMatrix();
 void testTranslation();
 void testRotation();
 void testInertia();
+void testReductions();
+void testAccumulateur();
 void testPaveDroit();
 void testFactorielSinusCosinus();
+void testConstexpr();
 void testCercle();
 void testCylindre();
-void testMouvement();
\ No newline at end of file
+void testGenerateurs();
+void testShape();
+void testInertieAnalytique();
+void testMouvement();
+void testStep();
+void testIntegrateurs();
+void testAdaptatif();
+void testGyroscopique();
+void testTrajectoire();
+void testSinks();
+void testGenerateurTrajectoire();
+void testWorld();
+void testThreadPool();
+void testEnsemble();
+void testPipeline();
+void testTransformation();
+void testTransform();
+void testInterpolation();
+void testChampsDeForce();
+void testBarnesHut();
+void testBroadphase();
\ No newline at end of file
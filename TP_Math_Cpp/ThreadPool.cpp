@@ -0,0 +1,181 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+	// Index of the queue of the current thread in the pool it works for, none for outside threads
+	thread_local const ThreadPool* poolCourant = nullptr;
+	thread_local std::size_t fileCourante = 0;
+
+	/**
+	 * Pin a thread to a processor
+	 * @param thread : Thread to pin
+	 * @param processeur : index of the processor
+	 */
+	void fixerAffinite(std::thread& thread, unsigned int processeur)
+	{
+#if defined(_WIN32)
+		SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << (processeur % (8 * sizeof(DWORD_PTR))));
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(processeur % CPU_SETSIZE, &set);
+		pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+		(void)thread;
+		(void)processeur;
+#endif
+	}
+}
+
+ThreadPool::ThreadPool(unsigned int threads, Affinite affinite)
+{
+	const unsigned int processeurs = std::max(std::thread::hardware_concurrency(), 1u);
+	if (threads == 0)
+		threads = processeurs;
+	// The calling thread is the last worker
+	const std::size_t n = threads - 1;
+	files = std::vector<File>(n + 1);
+	workers.reserve(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		workers.emplace_back([this, i]() { boucle(i); });
+		if (affinite == Affinite::Compacte)
+			fixerAffinite(workers.back(), static_cast<unsigned int>((i + 1) % processeurs));
+		else if (affinite == Affinite::Dispersee)
+			fixerAffinite(workers.back(), static_cast<unsigned int>((i + 1) * processeurs / threads % processeurs));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutexSommeil);
+		arret = true;
+	}
+	reveil.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::lancer(std::size_t count, void (*appel)(void*, std::size_t), void* fonction, Groupe& groupe)
+{
+	if (count == 0)
+		return;
+	// Counted before being queued, so the count never goes below the number of queued tasks
+	enAttente += count;
+	if (poolCourant == this)
+	{
+		// A worker keeps its tasks, idle workers will steal them
+		File& file = files[fileCourante];
+		std::lock_guard<std::mutex> lock(file.mutex);
+		for (std::size_t i = 0; i < count; ++i)
+			file.taches.push_back({ appel, fonction, i, &groupe });
+	}
+	else
+	{
+		// Deal the tasks over the queues, in contiguous runs so neighbouring indices stay on the same worker
+		const std::size_t n = files.size();
+		const std::size_t premiere = suivante.fetch_add(1) % n;
+		for (std::size_t f = 0; f < n; ++f)
+		{
+			File& file = files[(premiere + f) % n];
+			std::lock_guard<std::mutex> lock(file.mutex);
+			for (std::size_t i = count * f / n; i < count * (f + 1) / n; ++i)
+				file.taches.push_back({ appel, fonction, i, &groupe });
+		}
+	}
+	{
+		// Taking the lock orders the wake-up after the check of a worker going to sleep
+		std::lock_guard<std::mutex> lock(mutexSommeil);
+	}
+	reveil.notify_all();
+}
+
+bool ThreadPool::prendre(std::size_t index, Tache& tache)
+{
+	// Own queue first, from the back
+	{
+		File& file = files[index];
+		std::lock_guard<std::mutex> lock(file.mutex);
+		if (!file.taches.empty())
+		{
+			tache = file.taches.back();
+			file.taches.pop_back();
+			--enAttente;
+			return true;
+		}
+	}
+	// Then steal the oldest task of another queue
+	for (std::size_t k = 1; k < files.size(); ++k)
+	{
+		File& file = files[(index + k) % files.size()];
+		std::lock_guard<std::mutex> lock(file.mutex);
+		if (!file.taches.empty())
+		{
+			tache = file.taches.front();
+			file.taches.pop_front();
+			--enAttente;
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::executerTache(const Tache& tache)
+{
+	try
+	{
+		tache.appel(tache.fonction, tache.index);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(tache.groupe->mutexErreur);
+		if (!tache.groupe->erreur)
+			tache.groupe->erreur = std::current_exception();
+	}
+	// Last access to the group, its owner may return as soon as the count reaches 0
+	tache.groupe->restants.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void ThreadPool::attendre(Groupe& groupe)
+{
+	// Outside threads work from the last queue, workers from their own
+	const std::size_t index = poolCourant == this ? fileCourante : files.size() - 1;
+	Tache tache;
+	while (groupe.restants.load(std::memory_order_acquire) > 0)
+	{
+		if (prendre(index, tache))
+			executerTache(tache);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void ThreadPool::boucle(std::size_t index)
+{
+	poolCourant = this;
+	fileCourante = index;
+	Tache tache;
+	while (true)
+	{
+		if (prendre(index, tache))
+		{
+			executerTache(tache);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutexSommeil);
+		reveil.wait(lock, [this]() { return arret || enAttente > 0; });
+		if (arret && enAttente == 0)
+			return;
+	}
+}
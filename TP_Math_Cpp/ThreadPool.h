@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing pool of threads shared by the parallel helpers of MathLib
+ * Each worker owns a queue: it takes its own tasks from the back and, once empty, steals from the front of the others.
+ * A thread waiting for its tasks runs queued tasks meanwhile, so parallel loops can be nested without deadlock
+ */
+class ThreadPool
+{
+public:
+	// Placement of the workers on the processors, a hint ignored where the system does not support it
+	enum class Affinite
+	{
+		Aucune,     // Let the system place the threads
+		Compacte,   // Worker i on processor i + 1, the calling thread is expected on processor 0
+		Dispersee   // Workers spread evenly over the processors
+	};
+
+	// threads is the total number of threads working on a loop, the calling one included; 0 for the hardware concurrency
+	explicit ThreadPool(unsigned int threads = 0, Affinite affinite = Affinite::Aucune);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Number of threads working on a loop: the workers and the calling thread
+	unsigned int size() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+	/**
+	 * Run tache(i) for every i in [0, count[ and return once all of them are done
+	 * The calling thread takes part, the first exception thrown by a task is rethrown here
+	 * @param count : number of tasks
+	 * @param tache : callable taking (std::size_t i)
+	 */
+	template<class Function>
+	void executer(std::size_t count, Function& tache)
+	{
+		Groupe groupe;
+		groupe.restants = count;
+		lancer(count, &appeler<Function>, &tache, groupe);
+		attendre(groupe);
+		if (groupe.erreur)
+			std::rethrow_exception(groupe.erreur);
+	}
+
+private:
+	// Tasks of one call of executer
+	struct Groupe
+	{
+		std::atomic<std::size_t> restants{ 0 };
+		std::mutex mutexErreur;
+		std::exception_ptr erreur;
+	};
+
+	// A task only points to the callable, which lives on the stack of the waiting caller
+	struct Tache
+	{
+		void (*appel)(void*, std::size_t);
+		void* fonction;
+		std::size_t index;
+		Groupe* groupe;
+	};
+
+	struct File
+	{
+		std::mutex mutex;
+		std::deque<Tache> taches;
+	};
+
+	template<class Function>
+	static void appeler(void* fonction, std::size_t i)
+	{
+		(*static_cast<Function*>(fonction))(i);
+	}
+
+	void lancer(std::size_t count, void (*appel)(void*, std::size_t), void* fonction, Groupe& groupe);
+	void attendre(Groupe& groupe);
+	void boucle(std::size_t index);
+	bool prendre(std::size_t index, Tache& tache);
+	static void executerTache(const Tache& tache);
+
+	std::vector<std::thread> workers;
+	std::vector<File> files;  // One per worker, the last one receives the tasks of outside threads
+	std::atomic<std::size_t> enAttente{ 0 };
+	std::atomic<std::size_t> suivante{ 0 };
+	std::mutex mutexSommeil;
+	std::condition_variable reveil;
+	bool arret = false;
+};
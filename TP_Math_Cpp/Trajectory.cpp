@@ -0,0 +1,147 @@
+#include "Trajectory.h"
+
+#include "MathLib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	// Same rotation as q, in the hemisphere of the reference so that the interpolation takes the short way
+	FQuaternion aligner(const FQuaternion& q, const FQuaternion& reference)
+	{
+		return q.dot(reference) < 0 ? FQuaternion(-q.getW(), -q.getX(), -q.getY(), -q.getZ()) : q;
+	}
+
+	/**
+	 * Tangent of squad at key i, aligned with q the orientation of the key
+	 * The first and the last keys have a single neighbour, they take the curvature of the next key inwards
+	 */
+	FQuaternion tangente(const std::vector<Pose>& poses, std::size_t i, const FQuaternion& q)
+	{
+		if (poses.size() < 3)
+			return q;
+		const std::size_t centre = std::min(std::max<std::size_t>(i, 1), poses.size() - 2);
+		const FQuaternion inverse = poses[centre].orientation.conjugate();
+		const FVector3 courbure = (inverse * poses[centre + 1].orientation).log() + (inverse * poses[centre - 1].orientation).log();
+		return (q * FQuaternion::exp(courbure * -0.25f)).normalized();
+	}
+
+	float norme(const FVector3& u)
+	{
+		return std::sqrt(u.getX() * u.getX() + u.getY() * u.getY() + u.getZ() * u.getZ());
+	}
+}
+
+Trajectory::Trajectory(const Matrix& W, const FVector3& G, const FVector3& teta)
+	: reference(repereCorps(W, G, teta))
+{
+}
+
+Matrix Trajectory::frame(std::size_t i) const
+{
+	Matrix W(3, reference.getCols());
+	frame(i, W);
+	return W;
+}
+
+void Trajectory::frame(std::size_t i, Matrix& W) const
+{
+	if (i >= poses.size())
+		throw std::out_of_range("Frame index out of range.");
+	placer(reference, poses[i], W);
+}
+
+Pose Trajectory::pose(float t, Interpolation mode) const
+{
+	if (poses.empty() || t < poses.front().t || t > poses.back().t)
+		throw std::out_of_range("Time out of the trajectory.");
+	// Key k starts the interval holding t
+	const auto suivante = std::upper_bound(poses.begin(), poses.end(), t, [](float t, const Pose& p) { return t < p.t; });
+	if (suivante == poses.end())
+		return poses.back();
+	const std::size_t k = static_cast<std::size_t>(suivante - poses.begin()) - 1;
+	const Pose& a = poses[k];
+	const Pose& b = poses[k + 1];
+	const float dt = b.t - a.t;
+	const float u = (t - a.t) / dt;
+
+	// Cubic Hermite basis and its derivative
+	const float u2 = u * u;
+	const float u3 = u2 * u;
+	const float h00 = 2 * u3 - 3 * u2 + 1;
+	const float h10 = u3 - 2 * u2 + u;
+	const float h01 = -2 * u3 + 3 * u2;
+	const float h11 = u3 - u2;
+	const float d00 = (6 * u2 - 6 * u) / dt;
+	const float d10 = 3 * u2 - 4 * u + 1;
+	const float d01 = (-6 * u2 + 6 * u) / dt;
+	const float d11 = 3 * u2 - 2 * u;
+
+	Pose resultat;
+	resultat.t = t;
+	resultat.G = a.G * h00 + a.v * (h10 * dt) + b.G * h01 + b.v * (h11 * dt);
+	resultat.v = a.G * d00 + a.v * d10 + b.G * d01 + b.v * d11;
+	resultat.tetap = a.tetap * (1 - u) + b.tetap * u;
+
+	const FQuaternion q1 = a.orientation;
+	const FQuaternion q2 = aligner(b.orientation, q1);
+	if (mode == Interpolation::Slerp)
+		resultat.orientation = FQuaternion::slerp(q1, q2, u);
+	else
+	{
+		resultat.orientation = FQuaternion::squad(q1, q2, tangente(poses, k, q1), tangente(poses, k + 1, q2), u);
+	}
+	return resultat;
+}
+
+void Trajectory::echantillon(float t, Matrix& W, Interpolation mode) const
+{
+	placer(reference, pose(t, mode), W);
+}
+
+EcartInterpolation Trajectory::ecart(const Trajectory& reference, Interpolation mode) const
+{
+	EcartInterpolation resultat;
+	if (poses.empty())
+		return resultat;
+	for (const Pose& r : reference.getPoses())
+	{
+		if (r.t < poses.front().t || r.t > poses.back().t)
+			continue;
+		const Pose p = pose(r.t, mode);
+		const float distance = norme(p.G - r.G);
+		const float angle = norme((p.orientation.conjugate() * r.orientation).log());
+		if (distance > resultat.position)
+		{
+			resultat.position = distance;
+			resultat.tPosition = r.t;
+		}
+		if (angle > resultat.angle)
+		{
+			resultat.angle = angle;
+			resultat.tAngle = r.t;
+		}
+		++resultat.echantillons;
+	}
+	return resultat;
+}
+
+Matrix Trajectory::repereCorps(const Matrix& W, const FVector3& G, const FVector3& teta)
+{
+	if (W.getRows() != 3)
+		throw std::invalid_argument("Solid matrix must have 3 rows");
+	// Bring the solid back to the body frame: centered on G and unrotated
+	Matrix reference(3, W.getCols());
+	const FMatrix3 Rt = FQuaternion::fromEuler(teta).conjugate().toRotationMatrix();
+	MathLib::transforme_points(W, reference, Rt, FVector3::Zero() - Rt * G);
+	return reference;
+}
+
+void Trajectory::placer(const Matrix& reference, const Pose& pose, Matrix& W)
+{
+	if (W.getRows() != 3 || W.getCols() != reference.getCols())
+		throw std::invalid_argument("Output matrix must be 3xN with the size of the solid");
+	MathLib::transforme_points(reference, W, pose.orientation.toRotationMatrix(), pose.G);
+}
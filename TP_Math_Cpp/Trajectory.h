@@ -0,0 +1,101 @@
+#pragma once
+
+#include "FQuaternion.h"
+#include "FVector3.h"
+#include "Integrators.h"
+#include "Matrix.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Pose of a solid at a given time: position, orientation and speeds
+ */
+struct Pose
+{
+	float t;                  // Time
+	FVector3 G;               // Center of gravity
+	FQuaternion orientation;  // Rotation from the body frame
+	FVector3 v;               // Linear speed
+	FVector3 tetap;           // Angular speed
+
+	// Angles around X, Y and Z of the orientation
+	FVector3 teta() const { return orientation.toEuler(); }
+
+	static Pose fromState(float t, const MotionState& e)
+	{
+		return { t, e.G, FQuaternion::fromEuler(e.teta), e.v, e.tetap };
+	}
+};
+
+// Interpolation of the orientation between two keyframes
+enum class Interpolation
+{
+	Slerp,  // Constant angular speed between the keys, the speed jumps at each key
+	Squad   // Spherical cubic, the angular speed is continuous across the keys
+};
+
+/**
+ * Largest gap between interpolated poses and a reference motion
+ */
+struct EcartInterpolation
+{
+	float position = 0;  // Distance between the centers of gravity
+	float tPosition = 0; // Time of the largest distance
+	float angle = 0;     // Angle of the rotation between the orientations, in radians
+	float tAngle = 0;    // Time of the largest angle
+	std::size_t echantillons = 0;  // Number of reference poses compared
+};
+
+/**
+ * Motion of a solid stored as one pose per frame and a single copy of its points in the body frame
+ * The points of a frame are only computed when asked for, always from the reference, so rotations never compound
+ */
+class Trajectory
+{
+public:
+	/**
+	 * @param W : Solid matrix at the start of the motion
+	 * @param G : Its center of gravity
+	 * @param teta : Its angles around X, Y and Z
+	 */
+	Trajectory(const Matrix& W, const FVector3& G, const FVector3& teta);
+
+	void reserve(std::size_t n) { poses.reserve(n); }
+	void ajouter(const Pose& pose) { poses.push_back(pose); }
+	void ajouter(float t, const MotionState& e) { poses.push_back(Pose::fromState(t, e)); }
+
+	std::size_t size() const { return poses.size(); }
+	const Pose& operator[](std::size_t i) const { return poses[i]; }
+	const std::vector<Pose>& getPoses() const { return poses; }
+	// Points of the solid centered on G at the orientation teta = 0
+	const Matrix& getReference() const { return reference; }
+
+	// Points of the solid at frame i
+	Matrix frame(std::size_t i) const;
+	// Same, written in a 3xN matrix provided by the caller, so a frame can be rebuilt without allocating
+	void frame(std::size_t i, Matrix& W) const;
+
+	/**
+	 * Pose at any time between the first and the last frame, the frames being used as keyframes
+	 * G follows the cubic Hermite spline of the positions and speeds of the keys, so its error shrinks as the fourth power
+	 * of the spacing of the keys, the orientation follows slerp or squad and the angular speed is linear
+	 * @param t : Time, within the times of the frames
+	 * @param mode : Interpolation of the orientation
+	 * @return : The interpolated pose
+	 */
+	Pose pose(float t, Interpolation mode = Interpolation::Squad) const;
+	// Points of the solid at the time t, in a 3xN matrix provided by the caller
+	void echantillon(float t, Matrix& W, Interpolation mode = Interpolation::Squad) const;
+	// Compare the interpolation with a denser motion of the same solid, at every pose of the reference within this one
+	EcartInterpolation ecart(const Trajectory& reference, Interpolation mode = Interpolation::Squad) const;
+
+	// Points of the solid W (center G, angles teta) in the body frame
+	static Matrix repereCorps(const Matrix& W, const FVector3& G, const FVector3& teta);
+	// Place points given in the body frame at a pose, W must be 3xN like the reference
+	static void placer(const Matrix& reference, const Pose& pose, Matrix& W);
+
+private:
+	Matrix reference;
+	std::vector<Pose> poses;
+};
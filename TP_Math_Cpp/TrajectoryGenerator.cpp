@@ -0,0 +1,39 @@
+#include "TrajectoryGenerator.h"
+
+#include <stdexcept>
+
+TrajectoryGenerator::TrajectoryGenerator(const RigidBody& corps, const std::vector<std::vector<FVector3>>& F,
+	const std::vector<std::vector<FVector3>>& A, float h, int n, int pas)
+	: corps(corps), F(F), A(A), h(h), n(n), pas(pas), pose(Pose::fromState(0.f, corps.getMotionState()))
+{
+	if (!(h > 0))
+		throw std::invalid_argument("Time step must be positive");
+	if (n < 0 && n != SANS_FIN)
+		throw std::invalid_argument("Number of steps must be positive or SANS_FIN");
+	if (pas < 1)
+		throw std::invalid_argument("Output stride must be at least 1");
+}
+
+bool TrajectoryGenerator::suivant()
+{
+	// The initial state is the first frame
+	if (etape < 0)
+	{
+		etape = 0;
+		return true;
+	}
+	if (n != SANS_FIN && etape + pas > n)
+		return false;
+	for (int i = 0; i < pas; i++)
+		corps.step(F, A, h);
+	etape += pas;
+	pose = Pose::fromState(static_cast<float>(etape) * h, corps.getMotionState());
+	return true;
+}
+
+TrajectoryGenerator::iterator TrajectoryGenerator::begin()
+{
+	if (etape < 0)
+		suivant();
+	return iterator(this);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "RigidBody.h"
+#include "Trajectory.h"
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/**
+ * Pull-based simulation: a frame is only computed when the consumer asks for it
+ * The consumer can stop at any time, nothing is computed ahead. Iterate it with a range-for, or call suivant()
+ * The first frame is the initial state, then one frame every pas steps of h
+ */
+class TrajectoryGenerator
+{
+public:
+	// Value of n for a simulation that only stops when the consumer does
+	static constexpr int SANS_FIN = -1;
+
+	TrajectoryGenerator(const RigidBody& corps, const std::vector<std::vector<FVector3>>& F,
+		const std::vector<std::vector<FVector3>>& A, float h, int n = SANS_FIN, int pas = 1);
+
+	// Compute the next frame, false once the n steps are done
+	bool suivant();
+	// Last frame computed
+	const Pose& courant() const { return pose; }
+	// Number of steps done so far
+	int getEtapes() const { return etape; }
+	const RigidBody& getCorps() const { return corps; }
+
+	/**
+	 * Single pass iterator over the frames, incrementing it runs the simulation
+	 */
+	class iterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = Pose;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Pose*;
+		using reference = const Pose&;
+
+		iterator() = default;
+		explicit iterator(TrajectoryGenerator* generateur) : generateur(generateur) {}
+
+		reference operator*() const { return generateur->courant(); }
+		pointer operator->() const { return &generateur->courant(); }
+		iterator& operator++()
+		{
+			if (!generateur->suivant())
+				generateur = nullptr;
+			return *this;
+		}
+		bool operator==(const iterator& other) const { return generateur == other.generateur; }
+		bool operator!=(const iterator& other) const { return generateur != other.generateur; }
+
+	private:
+		TrajectoryGenerator* generateur = nullptr;
+	};
+
+	// Starts the simulation if needed, iterating again resumes from the current frame
+	iterator begin();
+	iterator end() { return iterator(); }
+
+private:
+	RigidBody corps;
+	std::vector<std::vector<FVector3>> F;
+	std::vector<std::vector<FVector3>> A;
+	float h;
+	int n;
+	int pas;
+	int etape = -1;  // -1 until the initial frame is produced
+	Pose pose;
+};
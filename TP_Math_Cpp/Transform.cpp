@@ -0,0 +1,42 @@
+#include "Transform.h"
+
+#include "Matrix.h"
+#include "TransformPoints.h"
+
+#include <sstream>
+#include <stdexcept>
+
+Matrix Transform::matrice() const
+{
+	Matrix M(4, 4);
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			M[i][j] = R[i][j] * s;
+	M[0][3] = T.getX();
+	M[1][3] = T.getY();
+	M[2][3] = T.getZ();
+	M[3][3] = 1;
+	return M;
+}
+
+/**
+ * Move every point of a solid in a single pass of MathLib::transforme_points
+ * @param source : Solid matrix with 3 rows representing the coordinates X, Y and Z
+ * @param W : Output, 3xN matrix of the same size, source itself to transform in place
+ */
+void Transform::appliquer(const Matrix& source, Matrix& W) const
+{
+	if (source.getCols() == 0)
+		return;
+	if (source.getRows() != 3 || W.getRows() != 3 || W.getCols() != source.getCols())
+		throw std::invalid_argument("Source and output must be 3xN matrices of the same size");
+	MathLib::transforme_points(source[0], source[1], source[2], W[0], W[1], W[2], source.getCols(), R * s,
+		FVector3::Zero(), T);
+}
+
+std::string Transform::ToString() const
+{
+	std::ostringstream oss;
+	oss << "R: " << R.ToString() << ", T: " << T.ToString() << ", s: " << s;
+	return oss.str();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FMatrix3.h"
+#include "FQuaternion.h"
+#include "FVector3.h"
+
+#include <string>
+
+class Matrix;
+
+/**
+ * Affine transform p -> R * (s * p) + T: rotation R, uniform scale s, then translation T
+ * Same as the homogeneous 4x4 matrix [ s R | T ; 0 0 0 1 ], but kept in parts so that the composition costs
+ * one 3x3 product and the inverse only a transpose, with no general 4x4 inversion.
+ * A chain of moves composes into one Transform, applied to the points once
+ */
+class Transform
+{
+public:
+	constexpr Transform() : R(FMatrix3::Identity()), T(FVector3::Zero()), s(1) {}
+	constexpr Transform(const FMatrix3& R, const FVector3& T, float s = 1) : R(R), T(T), s(s) {}
+
+	// Composition, a * b applies b then a
+	Transform operator*(const Transform& other) const
+	{
+		return { R * other.R, R * other.T * s + T, s * other.s };
+	}
+
+	// Transform a point
+	FVector3 operator*(const FVector3& point) const { return R * point * s + T; }
+	// Transform a direction, the translation does not apply
+	FVector3 vecteur(const FVector3& direction) const { return R * direction * s; }
+
+	// Inverse transform, R must be a rotation
+	Transform inverse() const
+	{
+		const FMatrix3 Rt = FMatrix3::tran(R);
+		return { Rt, Rt * T * (-1 / s), 1 / s };
+	}
+
+	constexpr const FMatrix3& getRotation() const { return R; }
+	constexpr const FVector3& getTranslation() const { return T; }
+	constexpr float getEchelle() const { return s; }
+
+	// Homogeneous 4x4 matrix
+	Matrix matrice() const;
+	// W = this * source for every point, W is a 3xN matrix of the size of source and may be source itself
+	void appliquer(const Matrix& source, Matrix& W) const;
+	std::string ToString() const;
+
+	static constexpr Transform translation(const FVector3& t) { return { FMatrix3::Identity(), t }; }
+	static constexpr Transform rotation(const FMatrix3& R) { return { R, FVector3::Zero() }; }
+	static Transform rotation(const FQuaternion& q) { return rotation(q.toRotationMatrix()); }
+	// Rotation around the point C, like MathLib::rotation_forme around G
+	static Transform rotation(const FMatrix3& R, const FVector3& C) { return { R, C - R * C }; }
+	static constexpr Transform echelle(float s) { return { FMatrix3::Identity(), FVector3::Zero(), s }; }
+
+private:
+	FMatrix3 R;
+	FVector3 T;
+	float s;
+};
@@ -0,0 +1,182 @@
+#include "TransformPoints.h"
+
+#include "Parallel.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define MATHLIB_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Compile a function for AVX2 and FMA whatever the flags of the project, it is only called when the processor has them
+#if defined(MATHLIB_X64) && defined(__GNUC__)
+#define CIBLE_AVX2_FMA __attribute__((target("avx2,fma")))
+#else
+#define CIBLE_AVX2_FMA
+#endif
+
+namespace
+{
+	// Coefficients of the transform, loaded once per block
+	struct Coefficients
+	{
+		float r[3][3];
+		float c[3];
+		float d[3];
+
+		Coefficients(const FMatrix3& R, const FVector3& C, const FVector3& D)
+			: r{ { R[0][0], R[0][1], R[0][2] }, { R[1][0], R[1][1], R[1][2] }, { R[2][0], R[2][1], R[2][2] } },
+			c{ C.getX(), C.getY(), C.getZ() }, d{ D.getX(), D.getY(), D.getZ() }
+		{
+		}
+	};
+
+	using Kernel = void (*)(const float*, const float*, const float*, float*, float*, float*, std::size_t, const Coefficients&);
+
+	/**
+	 * Reference kernel, same operations in the same order as R * (P - C) + D with FVector3 and FMatrix3
+	 */
+	void transformeScalaire(const float* X, const float* Y, const float* Z, float* outX, float* outY, float* outZ,
+		std::size_t n, const Coefficients& k)
+	{
+		for (std::size_t i = 0; i < n; i++)
+		{
+			const float px = X[i] - k.c[0];
+			const float py = Y[i] - k.c[1];
+			const float pz = Z[i] - k.c[2];
+			outX[i] = px * k.r[0][0] + py * k.r[0][1] + pz * k.r[0][2] + k.d[0];
+			outY[i] = px * k.r[1][0] + py * k.r[1][1] + pz * k.r[1][2] + k.d[1];
+			outZ[i] = px * k.r[2][0] + py * k.r[2][1] + pz * k.r[2][2] + k.d[2];
+		}
+	}
+
+#ifdef MATHLIB_X64
+	/**
+	 * 4 points per iteration, the operations of the scalar kernel so the results are identical to it
+	 * Every point is read before its slot is written, which keeps the in place transform valid
+	 */
+	void transformeSSE2(const float* X, const float* Y, const float* Z, float* outX, float* outY, float* outZ,
+		std::size_t n, const Coefficients& k)
+	{
+		__m128 r[3][3];
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				r[i][j] = _mm_set1_ps(k.r[i][j]);
+		const __m128 cx = _mm_set1_ps(k.c[0]), cy = _mm_set1_ps(k.c[1]), cz = _mm_set1_ps(k.c[2]);
+		const __m128 dx = _mm_set1_ps(k.d[0]), dy = _mm_set1_ps(k.d[1]), dz = _mm_set1_ps(k.d[2]);
+
+		std::size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			const __m128 px = _mm_sub_ps(_mm_loadu_ps(X + i), cx);
+			const __m128 py = _mm_sub_ps(_mm_loadu_ps(Y + i), cy);
+			const __m128 pz = _mm_sub_ps(_mm_loadu_ps(Z + i), cz);
+			const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, r[0][0]), _mm_mul_ps(py, r[0][1])), _mm_mul_ps(pz, r[0][2])), dx);
+			const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, r[1][0]), _mm_mul_ps(py, r[1][1])), _mm_mul_ps(pz, r[1][2])), dy);
+			const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, r[2][0]), _mm_mul_ps(py, r[2][1])), _mm_mul_ps(pz, r[2][2])), dz);
+			_mm_storeu_ps(outX + i, rx);
+			_mm_storeu_ps(outY + i, ry);
+			_mm_storeu_ps(outZ + i, rz);
+		}
+		transformeScalaire(X + i, Y + i, Z + i, outX + i, outY + i, outZ + i, n - i, k);
+	}
+
+	/**
+	 * 8 points per iteration with fused multiply-adds
+	 * The remaining points use std::fma in the same order, so a point gets the same result wherever the blocks start
+	 */
+	CIBLE_AVX2_FMA void transformeAVX2(const float* X, const float* Y, const float* Z, float* outX, float* outY, float* outZ,
+		std::size_t n, const Coefficients& k)
+	{
+		__m256 r[3][3];
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				r[i][j] = _mm256_set1_ps(k.r[i][j]);
+		const __m256 cx = _mm256_set1_ps(k.c[0]), cy = _mm256_set1_ps(k.c[1]), cz = _mm256_set1_ps(k.c[2]);
+		const __m256 dx = _mm256_set1_ps(k.d[0]), dy = _mm256_set1_ps(k.d[1]), dz = _mm256_set1_ps(k.d[2]);
+
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			const __m256 px = _mm256_sub_ps(_mm256_loadu_ps(X + i), cx);
+			const __m256 py = _mm256_sub_ps(_mm256_loadu_ps(Y + i), cy);
+			const __m256 pz = _mm256_sub_ps(_mm256_loadu_ps(Z + i), cz);
+			const __m256 rx = _mm256_add_ps(_mm256_fmadd_ps(pz, r[0][2], _mm256_fmadd_ps(py, r[0][1], _mm256_mul_ps(px, r[0][0]))), dx);
+			const __m256 ry = _mm256_add_ps(_mm256_fmadd_ps(pz, r[1][2], _mm256_fmadd_ps(py, r[1][1], _mm256_mul_ps(px, r[1][0]))), dy);
+			const __m256 rz = _mm256_add_ps(_mm256_fmadd_ps(pz, r[2][2], _mm256_fmadd_ps(py, r[2][1], _mm256_mul_ps(px, r[2][0]))), dz);
+			_mm256_storeu_ps(outX + i, rx);
+			_mm256_storeu_ps(outY + i, ry);
+			_mm256_storeu_ps(outZ + i, rz);
+		}
+		for (; i < n; i++)
+		{
+			const float px = X[i] - k.c[0];
+			const float py = Y[i] - k.c[1];
+			const float pz = Z[i] - k.c[2];
+			outX[i] = std::fma(pz, k.r[0][2], std::fma(py, k.r[0][1], px * k.r[0][0])) + k.d[0];
+			outY[i] = std::fma(pz, k.r[1][2], std::fma(py, k.r[1][1], px * k.r[1][0])) + k.d[1];
+			outZ[i] = std::fma(pz, k.r[2][2], std::fma(py, k.r[2][1], px * k.r[2][0])) + k.d[2];
+		}
+	}
+
+	// The processor and the operating system support AVX2 and FMA
+	bool avx2Fma()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		// The system saves the SSE and AVX registers on a context switch
+		if (!fma || !osxsave || !avx || (_xgetbv(0) & 6) != 6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	}
+#endif
+
+	// Kernel picked once for the processor running the program
+	Kernel kernel()
+	{
+#ifdef MATHLIB_X64
+		static const Kernel choisi = avx2Fma() ? transformeAVX2 : transformeSSE2;
+		return choisi;
+#else
+		return transformeScalaire;
+#endif
+	}
+}
+
+void MathLib::transforme_bloc(const float* X, const float* Y, const float* Z, float* outX, float* outY, float* outZ,
+	std::size_t n, const FMatrix3& R, const FVector3& C, const FVector3& D)
+{
+	kernel()(X, Y, Z, outX, outY, outZ, n, Coefficients(R, C, D));
+}
+
+void MathLib::transforme_points(const float* X, const float* Y, const float* Z, float* outX, float* outY, float* outZ,
+	std::size_t n, const FMatrix3& R, const FVector3& C, const FVector3& D)
+{
+	const Kernel k = kernel();
+	const Coefficients coefficients(R, C, D);
+	parallel_for(0, n, PARALLEL_GRAIN, [&](std::size_t first, std::size_t last)
+	{
+		k(X + first, Y + first, Z + first, outX + first, outY + first, outZ + first, last - first, coefficients);
+	});
+}
+
+const char* MathLib::jeuInstructions()
+{
+#ifdef MATHLIB_X64
+	return kernel() == transformeAVX2 ? "AVX2+FMA" : "SSE2";
+#else
+	return "scalaire";
+#endif
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "FMatrix3.h"
+#include "FVector3.h"
+
+#include <cstddef>
+
+/**
+ * Rigid transform of large point sets stored as coordinate arrays (structure of arrays, like the rows of a 3xN Matrix)
+ * out = R * (p - C) + D for every point p, on every thread of the pool and with the widest vectors of the processor:
+ * AVX2 with FMA when the processor has it (checked at run time), SSE2 otherwise, plain C++ off x86
+ */
+namespace MathLib
+{
+	/**
+	 * @param X, Y, Z : Coordinates of the n points
+	 * @param outX, outY, outZ : Output coordinates, either distinct from the inputs or equal to them (in place)
+	 * @param n : Number of points
+	 * @param R : Rotation matrix
+	 * @param C : Center of the rotation, subtracted before rotating
+	 * @param D : Added after rotating, C + t to rotate around C then translate by t
+	 */
+	void transforme_points(const float* X, const float* Y, const float* Z, float* outX, float* outY, float* outZ,
+		std::size_t n, const FMatrix3& R, const FVector3& C, const FVector3& D);
+
+	// Same on a single thread, for callers that already split the work
+	void transforme_bloc(const float* X, const float* Y, const float* Z, float* outX, float* outY, float* outZ,
+		std::size_t n, const FMatrix3& R, const FVector3& C, const FVector3& D);
+
+	// Instruction set picked by transforme_bloc on this processor: "AVX2+FMA", "SSE2" or "scalaire"
+	const char* jeuInstructions();
+}
@@ -0,0 +1,44 @@
+#include "Welford.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Welford::ajouter(double x)
+{
+	min = n == 0 ? x : std::min(min, x);
+	max = n == 0 ? x : std::max(max, x);
+	++n;
+	const double delta = x - moyenne;
+	moyenne += delta / static_cast<double>(n);
+	m2 += delta * (x - moyenne);
+}
+
+void Welford::fusionner(const Welford& other)
+{
+	if (other.n == 0)
+		return;
+	if (n == 0)
+	{
+		*this = other;
+		return;
+	}
+	const double na = static_cast<double>(n);
+	const double nb = static_cast<double>(other.n);
+	const double total = na + nb;
+	const double delta = other.moyenne - moyenne;
+	moyenne += delta * nb / total;
+	m2 += other.m2 + delta * delta * na * nb / total;
+	min = std::min(min, other.min);
+	max = std::max(max, other.max);
+	n += other.n;
+}
+
+double Welford::variance() const
+{
+	return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0;
+}
+
+double Welford::ecartType() const
+{
+	return std::sqrt(variance());
+}
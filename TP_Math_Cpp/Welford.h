@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Running mean, variance, minimum and maximum of a series of values (Welford's algorithm)
+ * Two series can be merged (Chan's formula), so partial statistics can be computed apart then combined
+ */
+struct Welford
+{
+	std::size_t n = 0;
+	double moyenne = 0;
+	double m2 = 0;  // Sum of the squared deviations from the mean
+	double min = 0;
+	double max = 0;
+
+	void ajouter(double x);
+	void fusionner(const Welford& other);
+
+	// Unbiased variance, 0 below two values
+	double variance() const;
+	double ecartType() const;
+};
@@ -0,0 +1,153 @@
+#include "World.h"
+
+#include "BarnesHut.h"
+#include "FMatrix3.h"
+#include "MathLib.h"
+#include "Parallel.h"
+
+#include <algorithm>
+
+void World::Composantes::set(std::size_t i, const FVector3& value)
+{
+	x[i] = value.getX();
+	y[i] = value.getY();
+	z[i] = value.getZ();
+}
+
+void World::Composantes::push_back(const FVector3& value)
+{
+	x.push_back(value.getX());
+	y.push_back(value.getY());
+	z.push_back(value.getZ());
+}
+
+void World::Composantes::reserve(std::size_t n)
+{
+	x.reserve(n);
+	y.reserve(n);
+	z.reserve(n);
+}
+
+std::size_t World::ajouter(float m, const Matrix& I, const FVector3& G, const FVector3& v, const FVector3& teta,
+	const FVector3& tetap)
+{
+	// Same inverse as MathLib::rotation
+	const FMatrix3 inverse = FMatrix3::fromMatrix(Matrix::inverse(I));
+	masses.push_back(m);
+	this->G.push_back(G);
+	this->v.push_back(v);
+	this->teta.push_back(teta);
+	this->tetap.push_back(tetap);
+	forces.push_back(FVector3::Zero());
+	couples.push_back(FVector3::Zero());
+	for (int k = 0; k < 9; k++)
+		I_inv[k].push_back(inverse[k / 3][k % 3]);
+	return masses.size() - 1;
+}
+
+void World::reserve(std::size_t n)
+{
+	masses.reserve(n);
+	G.reserve(n);
+	v.reserve(n);
+	teta.reserve(n);
+	tetap.reserve(n);
+	forces.reserve(n);
+	couples.reserve(n);
+	for (auto& composante : I_inv)
+		composante.reserve(n);
+}
+
+void World::appliquerForce(std::size_t i, const FVector3& F)
+{
+	forces.set(i, forces.get(i) + F);
+}
+
+void World::appliquerForce(std::size_t i, const FVector3& F, const FVector3& A)
+{
+	forces.set(i, forces.get(i) + F);
+	couples.set(i, couples.get(i) + FVector3::moment(F, A, G.get(i)));
+}
+
+void World::appliquerGravitation(BarnesHut& arbre, float constante)
+{
+	arbre.construire(G.x.data(), G.y.data(), G.z.data(), masses.data(), size());
+	arbre.forces(forces.x.data(), forces.y.data(), forces.z.data(), constante);
+}
+
+void World::effacerForces()
+{
+	for (Composantes* c : { &forces, &couples })
+	{
+		std::fill(c->x.begin(), c->x.end(), 0.f);
+		std::fill(c->y.begin(), c->y.end(), 0.f);
+		std::fill(c->z.begin(), c->z.end(), 0.f);
+	}
+}
+
+namespace
+{
+	// Bodies updated coordinate by coordinate at once, small enough for their arrays to stay in cache between passes
+	constexpr std::size_t BLOC = 512;
+
+	/**
+	 * Translation of one coordinate for bodies [first, last[, as in MathLib::translation
+	 * The arrays never overlap: telling the compiler so (restrict) lets it vectorize the loop
+	 * @param G : Positions, updated
+	 * @param v : Speeds, updated
+	 * @param F : Forces
+	 * @param m : Masses
+	 * @param g : Gravity
+	 */
+	void translater(std::size_t first, std::size_t last, float h, float g, float* __restrict G, float* __restrict v,
+		const float* __restrict F, const float* __restrict m)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			v[i] = MathLib::solve1(v[i], F[i] / m[i] + g, h);
+			G[i] = MathLib::solve1(G[i], v[i], h);
+		}
+	}
+
+	/**
+	 * Rotation of one coordinate for bodies [first, last[, as in MathLib::rotation
+	 * @param teta : Angles, updated
+	 * @param tetap : Angular speeds, updated
+	 * @param Cx, Cy, Cz : Torques
+	 * @param I0, I1, I2 : Row of the inverse inertia matching the coordinate
+	 */
+	void tourner(std::size_t first, std::size_t last, float h, float* __restrict teta, float* __restrict tetap,
+		const float* __restrict Cx, const float* __restrict Cy, const float* __restrict Cz,
+		const float* __restrict I0, const float* __restrict I1, const float* __restrict I2)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			tetap[i] = MathLib::solve1(tetap[i], Cx[i] * I0[i] + Cy[i] * I1[i] + Cz[i] * I2[i], h);
+			teta[i] = MathLib::solve1(teta[i], tetap[i], h);
+		}
+	}
+}
+
+/**
+ * Move every solid by one time step, with the update of MathLib::translation and MathLib::rotation
+ * @param h : Time step
+ */
+void World::step(float h)
+{
+	MathLib::parallel_for(0, size(), GRAIN, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t debut = first; debut < last; debut += BLOC)
+		{
+			const std::size_t fin = std::min(last, debut + BLOC);
+			translater(debut, fin, h, gravite.getX(), G.x.data(), v.x.data(), forces.x.data(), masses.data());
+			translater(debut, fin, h, gravite.getY(), G.y.data(), v.y.data(), forces.y.data(), masses.data());
+			translater(debut, fin, h, gravite.getZ(), G.z.data(), v.z.data(), forces.z.data(), masses.data());
+			const float* Cx = couples.x.data();
+			const float* Cy = couples.y.data();
+			const float* Cz = couples.z.data();
+			tourner(debut, fin, h, teta.x.data(), tetap.x.data(), Cx, Cy, Cz, I_inv[0].data(), I_inv[1].data(), I_inv[2].data());
+			tourner(debut, fin, h, teta.y.data(), tetap.y.data(), Cx, Cy, Cz, I_inv[3].data(), I_inv[4].data(), I_inv[5].data());
+			tourner(debut, fin, h, teta.z.data(), tetap.z.data(), Cx, Cy, Cz, I_inv[6].data(), I_inv[7].data(), I_inv[8].data());
+		}
+	});
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "FVector3.h"
+#include "Integrators.h"
+#include "Matrix.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class BarnesHut;
+
+/**
+ * Set of independent solids stepped together
+ * Every quantity is stored as one array per coordinate (structure of arrays), so stepping is a few loops over
+ * contiguous floats that the compiler turns into vector instructions (8 bodies at once with AVX), split across
+ * threads by slabs of bodies
+ * The update is the one of MathLib::translation and MathLib::rotation: semi-implicit Euler with a constant inverse inertia
+ */
+class World
+{
+public:
+	// Minimum number of bodies per thread
+	static constexpr std::size_t GRAIN = 4096;
+
+	/**
+	 * Add a solid to the world
+	 * @param m : Mass
+	 * @param I : Inertia matrix
+	 * @param G : Center of gravity
+	 * @param v : Linear speed
+	 * @param teta : Angular vector
+	 * @param tetap : Angular speed
+	 * @return : Index of the solid
+	 */
+	std::size_t ajouter(float m, const Matrix& I, const FVector3& G, const FVector3& v = FVector3::Zero(),
+		const FVector3& teta = FVector3::Zero(), const FVector3& tetap = FVector3::Zero());
+	void reserve(std::size_t n);
+	std::size_t size() const { return masses.size(); }
+
+	// Acceleration applied to every solid
+	void setGravite(const FVector3& g) { gravite = g; }
+	// Add a force applied at the center of gravity of solid i
+	void appliquerForce(std::size_t i, const FVector3& F);
+	// Add a force applied at the point A, its moment is taken about the current center of gravity
+	void appliquerForce(std::size_t i, const FVector3& F, const FVector3& A);
+	/**
+	 * Add the mutual gravitation of the solids to their forces, each one seen as a point mass at its center of gravity
+	 * @param arbre : Tree rebuilt on the current positions, kept by the caller to reuse its memory from step to step
+	 * @param constante : Gravitational constant
+	 */
+	void appliquerGravitation(BarnesHut& arbre, float constante);
+	// Remove the forces of every solid, they are otherwise kept from one step to the next
+	void effacerForces();
+
+	// Move every solid by one time step
+	void step(float h);
+
+	float getMasse(std::size_t i) const { return masses[i]; }
+	FVector3 getG(std::size_t i) const { return G.get(i); }
+	FVector3 getV(std::size_t i) const { return v.get(i); }
+	FVector3 getTeta(std::size_t i) const { return teta.get(i); }
+	FVector3 getTetap(std::size_t i) const { return tetap.get(i); }
+	MotionState getMotionState(std::size_t i) const { return { G.get(i), v.get(i), teta.get(i), tetap.get(i) }; }
+
+private:
+	// One array per coordinate of a vector quantity
+	struct Composantes
+	{
+		std::vector<float> x, y, z;
+
+		FVector3 get(std::size_t i) const { return { x[i], y[i], z[i] }; }
+		void set(std::size_t i, const FVector3& value);
+		void push_back(const FVector3& value);
+		void reserve(std::size_t n);
+	};
+
+	std::vector<float> masses;
+	Composantes G, v, teta, tetap;
+	Composantes forces;   // Sum of the forces
+	Composantes couples;  // Sum of their moments about G
+	std::array<std::vector<float>, 9> I_inv;  // Inverse inertia, row major
+	FVector3 gravite;
+};
@@ -12,11 +12,34 @@ int main()
 	//testTranslation();
 	//testRotation();
 	//testInertia();
+	//testReductions();
+	//testAccumulateur();
 	//testPaveDroit();
 	//testFactorielSinusCosinus();
+	//testConstexpr();
 	//testCercle();
 	//testCylindre();
+	//testGenerateurs();
+	//testShape();
+	//testInertieAnalytique();
 	testMouvement();
+	//testStep();
+	//testIntegrateurs();
+	//testAdaptatif();
+	//testGyroscopique();
+	//testTrajectoire();
+	//testSinks();
+	//testGenerateurTrajectoire();
+	//testWorld();
+	//testThreadPool();
+	//testEnsemble();
+	//testPipeline();
+	//testTransformation();
+	//testTransform();
+	//testInterpolation();
+	//testChampsDeForce();
+	//testBarnesHut();
+	//testBroadphase();
 	
 	_CrtSetReportMode(_CRT_WARN, _CRTDBG_MODE_DEBUG); 
 	_CrtDumpMemoryLeaks();